@@ -0,0 +1,768 @@
+// aht10.c - Aosong AHT10 temperature & humidity sensor driver
+//
+// A measurement is a small state machine driven by a delayable work item:
+// aht10_trigger() sends the trigger command and schedules the work for the
+// end of the conversion window, so the caller never sleeps on the bus.
+// The work item polls the busy flag until the conversion is done and then
+// reads the frame, raising the poll signal and calling the user callback.
+// The standard sensor API (sample_fetch/channel_get) is built on top of it.
+// The work item runs on the system work queue unless a dedicated queue is
+// set, e.g. one per bus so sensors on different buses are polled in
+// parallel.
+//
+// With CONFIG_AHT10_READOUT_FULL_FRAME every poll reads the whole 6-byte
+// frame, so the poll that sees the busy flag clear already carries the
+// data and a typical sample costs two transactions (trigger + read)
+// instead of three.
+//
+// Each sample is stamped from the 64-bit cycle counter the moment the
+// busy flag is seen clear, i.e. when the conversion is known complete,
+// not when somebody gets round to collecting it.
+//
+// Every measurement has a deadline (busy-timeout-ms after the trigger),
+// so a sensor stuck busy ends it with -ETIMEDOUT instead of being polled
+// forever. Any failure marks the sensor faulted; the next trigger first
+// clocks the bus free with i2c_recover_bus() and re-initializes the
+// sensor. Failed attempts back off exponentially, and triggers in between
+// fail right away with -EAGAIN, so no call waits on a dead sensor.
+//
+// AHT20 and AHT21 parts are handled too. Unless the devicetree names the
+// part, the boot setup tells them apart by the first frames it reads:
+// only those parts follow each with a matching CRC-8, and it takes two in
+// a row to rule out a chance match. If the AHT20 init command then fails,
+// the part is taken for an AHT10 after all. Their frames are checked
+// against the CRC, and one that fails is read again (the sensor keeps the
+// result) rather than reported.
+//
+// With CONFIG_AHT10_FAST_INIT the boot setup looks at the status byte of
+// the detection read (or reads it, if the devicetree names the part) and
+// leaves a sensor that is already calibrated and idle alone, saving the
+// 30 ms of reset and init waits. Recovery always does the full reset.
+
+#define DT_DRV_COMPAT aosong_aht10
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <app/lib/latency.h>
+#include <app/lib/sample_clock.h>
+
+#include "aht10.h"
+
+LOG_MODULE_REGISTER(aht10, CONFIG_AHT10_LOG_LEVEL);
+
+// Per-stage timing of a measurement (CONFIG_LATENCY_PROBES)
+LATENCY_HIST_DEFINE(aht10_trigger_write);
+LATENCY_HIST_DEFINE(aht10_conversion_wait);
+LATENCY_HIST_DEFINE(aht10_status_poll);
+LATENCY_HIST_DEFINE(aht10_data_read);
+
+// CRC-8, polynomial x^8 + x^5 + x^4 + 1 (0x31), one lookup per byte
+static const uint8_t aht10_crc8_table[256] = {
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97,
+    0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4,
+    0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+    0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11,
+    0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+    0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52,
+    0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+    0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA,
+    0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+    0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9,
+    0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C,
+    0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+    0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F,
+    0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+    0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED,
+    0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE,
+    0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+    0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B,
+    0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+    0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28,
+    0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0,
+    0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93,
+    0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+    0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56,
+    0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+    0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15,
+    0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC,
+};
+
+uint8_t aht10_crc8(const uint8_t *buf, size_t len)
+{
+    uint8_t crc = 0xFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc = aht10_crc8_table[crc ^ buf[i]];
+    }
+
+    return crc;
+}
+
+static uint32_t aht10_frame_len(const struct aht10_data *data)
+{
+    return (data->variant == AHT10_VARIANT_AHT20) ? AHT20_DATA_LEN : AHT10_DATA_LEN;
+}
+
+static void aht10_unpack(const uint8_t *buf, struct aht10_sample *sample)
+{
+    // Humidity is bits 19:0 of buf[1:3], temperature bits 19:0 of buf[3:5]
+    sample->raw_humidity = ((uint32_t)buf[1] << 12) |
+                           ((uint32_t)buf[2] << 4) |
+                           ((uint32_t)buf[3] >> 4);
+    sample->raw_temperature = (((uint32_t)buf[3] & 0x0F) << 16) |
+                              ((uint32_t)buf[4] << 8) |
+                              (uint32_t)buf[5];
+}
+
+// Bus accessors that account for every transaction of a measurement
+static int aht10_bus_write(struct aht10_data *data, const uint8_t *buf,
+                           uint32_t len)
+{
+    const struct aht10_config *cfg = data->dev->config;
+
+    data->bus_last.transactions++;
+    data->bus_last.bytes += len;
+    return i2c_write_dt(&cfg->bus, buf, len);
+}
+
+static int aht10_bus_read(struct aht10_data *data, uint8_t *buf, uint32_t len)
+{
+    const struct aht10_config *cfg = data->dev->config;
+
+    data->bus_last.transactions++;
+    data->bus_last.bytes += len;
+    return i2c_read_dt(&cfg->bus, buf, len);
+}
+
+// Check an AHT20/AHT21 frame against its CRC. A mismatch is most likely
+// noise on the bus, and the sensor keeps the result until the next
+// trigger, so the frame is read again up to CONFIG_AHT10_CRC_RETRIES times.
+static int aht10_check_frame(struct aht10_data *data, uint8_t *buf)
+{
+    int ret;
+
+    if (data->variant != AHT10_VARIANT_AHT20) {
+        return 0;
+    }
+
+    for (int retry = 0; ; retry++) {
+        if (aht10_crc8(buf, AHT10_DATA_LEN) == buf[AHT10_DATA_LEN]) {
+            return 0;
+        }
+
+        data->faults.crc_errors++;
+        if (retry == CONFIG_AHT10_CRC_RETRIES) {
+            LOG_ERR("%s: CRC mismatch on %d read(s)", data->dev->name, retry + 1);
+            return -EBADMSG;
+        }
+
+        ret = aht10_bus_read(data, buf, AHT20_DATA_LEN);
+        if (ret != 0) {
+            LOG_ERR("%s: data re-read failed (%d)", data->dev->name, ret);
+            data->faults.bus_errors++;
+            return ret;
+        }
+    }
+}
+
+// Every state change happens under the lock that aht10_trigger() and
+// aht10_collect() test the state under
+static void aht10_set_state(struct aht10_data *data, enum aht10_state state)
+{
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    data->state = state;
+    k_spin_unlock(&data->lock, key);
+}
+
+static void aht10_finish(struct aht10_data *data, int result)
+{
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+    aht10_callback_t cb = data->cb;
+    void *user_data = data->user_data;
+
+    if (result != 0) {
+        data->faulted = true;
+    }
+    data->result = result;
+    data->state = AHT10_STATE_READY;
+    data->bus_total.transactions += data->bus_last.transactions;
+    data->bus_total.bytes += data->bus_last.bytes;
+    k_spin_unlock(&data->lock, key);
+
+    k_poll_signal_raise(&data->signal, result);
+    if (cb != NULL) {
+        cb(data->dev, result, user_data);
+    }
+}
+
+static void aht10_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct aht10_data *data = CONTAINER_OF(dwork, struct aht10_data, work);
+    const struct aht10_config *cfg = data->dev->config;
+    uint8_t buf[AHT20_DATA_LEN];
+    const uint32_t frame_len = aht10_frame_len(data);
+    const uint32_t poll_len =
+        IS_ENABLED(CONFIG_AHT10_READOUT_FULL_FRAME) ? frame_len : 1;
+    uint64_t timestamp_us;
+    int ret;
+
+    // Either poll with the full frame, or with a cheap status byte and
+    // pull the frame in a second transaction once the sensor is ready
+    LATENCY_START(poll_start);
+    ret = aht10_bus_read(data, buf, poll_len);
+    LATENCY_END(aht10_status_poll, poll_start);
+    if (ret != 0) {
+        LOG_ERR("%s: status read failed (%d)", data->dev->name, ret);
+        data->faults.bus_errors++;
+        aht10_finish(data, ret);
+        return;
+    }
+
+    if (buf[0] & AHT10_STATUS_BUSY) {
+        if (sys_timepoint_expired(data->deadline)) {
+            LOG_WRN("%s: still busy after %u ms", data->dev->name,
+                    cfg->busy_timeout_ms);
+            data->faults.timeouts++;
+            aht10_finish(data, -ETIMEDOUT);
+            return;
+        }
+        aht10_set_state(data, AHT10_STATE_POLLING);
+        k_work_reschedule_for_queue(data->workq, &data->work,
+                                    K_MSEC(cfg->poll_interval_ms));
+        return;
+    }
+
+    timestamp_us = sample_clock_now_us();
+
+#ifdef CONFIG_LATENCY_PROBES
+    // Trigger written until the busy flag was seen clear
+    latency_record(&aht10_conversion_wait, k_cycle_get_32() - data->trigger_cycles);
+#endif
+
+    if (!IS_ENABLED(CONFIG_AHT10_READOUT_FULL_FRAME)) {
+        LATENCY_START(read_start);
+        ret = aht10_bus_read(data, buf, frame_len);
+        LATENCY_END(aht10_data_read, read_start);
+    }
+
+    if (ret != 0) {
+        LOG_ERR("%s: data read failed (%d)", data->dev->name, ret);
+        data->faults.bus_errors++;
+        aht10_finish(data, ret);
+        return;
+    }
+
+    ret = aht10_check_frame(data, buf);
+    if (ret == 0) {
+        data->variant_confirmed = true;
+        aht10_unpack(buf, &data->sample);
+        data->sample.timestamp_us = timestamp_us;
+    }
+
+    aht10_finish(data, ret);
+}
+
+static int aht10_setup(const struct device *dev, bool reset);
+
+// Unlock the bus and re-initialize a faulted sensor, unless still backing
+// off from the last failed attempt. Called with the state machine claimed.
+static int aht10_recover(const struct device *dev)
+{
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+    int ret;
+
+    if (!sys_timepoint_expired(data->retry_at)) {
+        return -EAGAIN;
+    }
+
+    // A target stopped mid-byte can hold SDA low; clock pulses on SCL
+    // let it finish and release the bus. Not every controller can.
+    ret = i2c_recover_bus(cfg->bus.bus);
+    if (ret != -ENOSYS) {
+        data->faults.bus_recoveries++;
+        if (ret != 0) {
+            LOG_WRN("%s: bus recovery failed (%d)", dev->name, ret);
+        }
+    }
+
+    ret = aht10_setup(dev, true);
+    if (ret != 0) {
+        data->faults.reinit_failures++;
+        data->retry_at = sys_timepoint_calc(K_MSEC(data->backoff_ms));
+        LOG_WRN("%s: re-init failed (%d), next attempt in %u ms", dev->name,
+                ret, data->backoff_ms);
+        data->backoff_ms = MIN(data->backoff_ms * 2,
+                               CONFIG_AHT10_RECOVERY_BACKOFF_MAX_MS);
+        return ret;
+    }
+
+    data->faults.reinits++;
+    data->faulted = false;
+    data->backoff_ms = CONFIG_AHT10_RECOVERY_BACKOFF_MIN_MS;
+    LOG_INF("%s: recovered", dev->name);
+    return 0;
+}
+
+int aht10_trigger(const struct device *dev, aht10_callback_t cb,
+                  void *user_data)
+{
+    static const uint8_t trigger_cmd[3] = {
+        AHT10_CMD_TRIGGER, AHT10_TRIGGER_PARAM0, AHT10_TRIGGER_PARAM1,
+    };
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+    k_spinlock_key_t key;
+    int ret;
+
+    key = k_spin_lock(&data->lock);
+    if (data->state == AHT10_STATE_TRIGGERED ||
+        data->state == AHT10_STATE_POLLING) {
+        k_spin_unlock(&data->lock, key);
+        return -EBUSY;
+    }
+    data->state = AHT10_STATE_TRIGGERED;
+    data->cb = cb;
+    data->user_data = user_data;
+    k_spin_unlock(&data->lock, key);
+
+    k_poll_signal_reset(&data->signal);
+    data->bus_last = (struct aht10_bus_stats){0};
+
+    if (data->faulted) {
+        ret = aht10_recover(dev);
+        if (ret != 0) {
+            aht10_set_state(data, AHT10_STATE_IDLE);
+            return ret;
+        }
+    }
+
+    LATENCY_START(write_start);
+    ret = aht10_bus_write(data, trigger_cmd, sizeof(trigger_cmd));
+    LATENCY_END(aht10_trigger_write, write_start);
+#ifdef CONFIG_LATENCY_PROBES
+    data->trigger_cycles = k_cycle_get_32();
+#endif
+    if (ret != 0) {
+        LOG_ERR("%s: trigger failed (%d)", dev->name, ret);
+        data->faults.bus_errors++;
+        data->faulted = true;
+        aht10_set_state(data, AHT10_STATE_IDLE);
+        return ret;
+    }
+
+    // Nothing to do on the bus until the conversion window has passed
+    data->deadline = sys_timepoint_calc(K_MSEC(cfg->busy_timeout_ms));
+    k_work_schedule_for_queue(data->workq, &data->work,
+                              K_MSEC(data->conversion_time_ms));
+
+    return 0;
+}
+
+int aht10_collect(const struct device *dev, struct aht10_sample *sample)
+{
+    struct aht10_data *data = dev->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+    int ret;
+
+    switch (data->state) {
+    case AHT10_STATE_IDLE:
+        ret = -ENODATA;
+        break;
+    case AHT10_STATE_READY:
+        ret = data->result;
+        if (ret == 0) {
+            *sample = data->sample;
+        }
+        data->state = AHT10_STATE_IDLE;
+        break;
+    default:
+        ret = -EAGAIN;
+        break;
+    }
+
+    k_spin_unlock(&data->lock, key);
+    return ret;
+}
+
+int aht10_set_work_queue(const struct device *dev, struct k_work_q *queue)
+{
+    struct aht10_data *data = dev->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+    int ret = 0;
+
+    if (data->state == AHT10_STATE_TRIGGERED ||
+        data->state == AHT10_STATE_POLLING) {
+        ret = -EBUSY;
+    } else {
+        data->workq = (queue != NULL) ? queue : &k_sys_work_q;
+    }
+
+    k_spin_unlock(&data->lock, key);
+    return ret;
+}
+
+struct k_poll_signal *aht10_get_signal(const struct device *dev)
+{
+    struct aht10_data *data = dev->data;
+
+    return &data->signal;
+}
+
+enum aht10_state aht10_get_state(const struct device *dev)
+{
+    struct aht10_data *data = dev->data;
+
+    return data->state;
+}
+
+void aht10_get_raw(const struct device *dev, struct aht10_sample *sample)
+{
+    struct aht10_data *data = dev->data;
+
+    *sample = data->last;
+}
+
+void aht10_get_fault_stats(const struct device *dev, struct aht10_fault_stats *stats)
+{
+    struct aht10_data *data = dev->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    *stats = data->faults;
+    k_spin_unlock(&data->lock, key);
+}
+
+enum aht10_variant aht10_get_variant(const struct device *dev)
+{
+    struct aht10_data *data = dev->data;
+
+    return data->variant;
+}
+
+bool aht10_reset_skipped(const struct device *dev)
+{
+    struct aht10_data *data = dev->data;
+
+    return data->reset_skipped;
+}
+
+void aht10_get_bus_stats(const struct device *dev, struct aht10_bus_stats *last,
+                         struct aht10_bus_stats *total)
+{
+    struct aht10_data *data = dev->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    if (last != NULL) {
+        *last = data->bus_last;
+    }
+    if (total != NULL) {
+        *total = data->bus_total;
+    }
+
+    k_spin_unlock(&data->lock, key);
+}
+
+int aht10_read(const struct device *dev, struct aht10_sample *sample,
+               k_timeout_t timeout)
+{
+    struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+        K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, aht10_get_signal(dev));
+    int ret;
+
+    ret = aht10_trigger(dev, NULL, NULL);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = k_poll(&event, 1, timeout);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return aht10_collect(dev, sample);
+}
+
+static int aht10_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+    struct aht10_data *data = dev->data;
+    struct aht10_sample sample;
+    int ret;
+
+    if (chan != SENSOR_CHAN_ALL && chan != SENSOR_CHAN_AMBIENT_TEMP &&
+        chan != SENSOR_CHAN_HUMIDITY) {
+        return -ENOTSUP;
+    }
+
+    // Blocking on the state machine from the work queue it runs on
+    // would never complete
+    if (k_current_get() == k_work_queue_thread_get(data->workq)) {
+        return -EDEADLK;
+    }
+
+    ret = aht10_read(dev, &sample, AHT10_FETCH_TIMEOUT);
+    if (ret != 0) {
+        return ret;
+    }
+
+    data->last = sample;
+    return 0;
+}
+
+static int aht10_channel_get(const struct device *dev, enum sensor_channel chan,
+                             struct sensor_value *val)
+{
+    struct aht10_data *data = dev->data;
+    int64_t micro;
+
+    // Full scale is 2^20 counts: -50..150 °C and 0..100 %RH
+    switch (chan) {
+    case SENSOR_CHAN_AMBIENT_TEMP:
+        micro = (((int64_t)data->last.raw_temperature * 200000000) >> 20) -
+                50000000;
+        break;
+    case SENSOR_CHAN_HUMIDITY:
+        micro = ((int64_t)data->last.raw_humidity * 100000000) >> 20;
+        break;
+    default:
+        return -ENOTSUP;
+    }
+
+    return sensor_value_from_micro(val, micro);
+}
+
+static DEVICE_API(sensor, aht10_driver_api) = {
+    .sample_fetch = aht10_sample_fetch,
+    .channel_get = aht10_channel_get,
+};
+
+static void aht10_set_variant(const struct device *dev, enum aht10_variant variant)
+{
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+
+    data->variant = variant;
+
+    if (cfg->conversion_time_ms != 0) {
+        data->conversion_time_ms = cfg->conversion_time_ms;
+    } else if (variant == AHT10_VARIANT_AHT20) {
+        data->conversion_time_ms = AHT20_CONVERSION_TIME_MS;
+    } else {
+        data->conversion_time_ms = AHT10_CONVERSION_TIME_MS;
+    }
+}
+
+static int aht10_read_status(const struct device *dev, uint8_t *status)
+{
+    const struct aht10_config *cfg = dev->config;
+    int ret;
+
+    ret = i2c_read_dt(&cfg->bus, status, 1);
+    if (ret != 0) {
+        LOG_ERR("%s: status read failed (%d)", dev->name, ret);
+    }
+
+    return ret;
+}
+
+// Tell the parts apart by the frames plain reads return: AHT20/AHT21
+// follow each with a matching CRC-8, an AHT10 with whatever the idle bus
+// reads back. One match in 256 is chance, so a second frame has to match
+// too (the sensor keeps its result; only a conversion finishing in
+// between changes it), leaving roughly 1 in 65536. Also sets the conversion time for the part and,
+// if @p status isn't NULL, gets the status byte: the latest frame's, or
+// a status read if the devicetree names the part.
+static int aht10_detect(const struct device *dev, uint8_t *status)
+{
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+    enum aht10_variant variant = AHT10_VARIANT_AHT10;
+    uint8_t buf[AHT20_DATA_LEN];
+    int ret;
+
+    if (data->variant != AHT10_VARIANT_UNKNOWN) {
+        aht10_set_variant(dev, data->variant);
+        return (status != NULL) ? aht10_read_status(dev, status) : 0;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        ret = i2c_read_dt(&cfg->bus, buf, sizeof(buf));
+        if (ret != 0) {
+            LOG_ERR("%s: detection read failed (%d)", dev->name, ret);
+            return ret;
+        }
+
+        if (aht10_crc8(buf, AHT10_DATA_LEN) != buf[AHT10_DATA_LEN]) {
+            break;
+        }
+        if (i == 1) {
+            variant = AHT10_VARIANT_AHT20;
+        }
+    }
+
+    aht10_set_variant(dev, variant);
+    LOG_INF("%s: %s detected", dev->name,
+            (variant == AHT10_VARIANT_AHT20) ? "AHT20/AHT21" : "AHT10");
+
+    if (status != NULL) {
+        *status = buf[0];
+    }
+
+    return 0;
+}
+
+// Send the part's init command and read back the status
+static int aht10_send_init(const struct device *dev, uint8_t *status)
+{
+    static const uint8_t aht10_init_cmd[3] = {AHT10_CMD_INIT, 0x08, 0x00};
+    static const uint8_t aht20_init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+    int ret;
+
+    ret = i2c_write_dt(&cfg->bus,
+                       (data->variant == AHT10_VARIANT_AHT20) ? aht20_init_cmd : aht10_init_cmd,
+                       sizeof(aht10_init_cmd));
+    if (ret != 0) {
+        LOG_ERR("%s: init command failed (%d)", dev->name, ret);
+        return ret;
+    }
+    k_msleep(AHT10_INIT_TIME_MS);
+
+    return aht10_read_status(dev, status);
+}
+
+// Soft reset, init command and calibration check, at boot and on recovery.
+// Without @reset, a sensor that reports calibrated and idle is left as is.
+static int aht10_setup(const struct device *dev, bool reset)
+{
+    const uint8_t reset_cmd = AHT10_CMD_SOFT_RESET;
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+    uint8_t status = 0;
+    int ret;
+
+    ret = aht10_detect(dev, reset ? NULL : &status);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Busy means a conversion from before an MCU reset is still running
+    // or hung; only a reset gets it back to a known state
+    if (!reset && (status & (AHT10_STATUS_CALIBRATED | AHT10_STATUS_BUSY)) ==
+        AHT10_STATUS_CALIBRATED) {
+        // Nothing confirmed the variant yet: the first frame that passes
+        // its check does, and one that fails sends the recovery through
+        // the full init, with its fallback
+        data->reset_skipped = true;
+        LOG_INF("%s: already calibrated, reset skipped (status: 0x%02X)",
+                dev->name, status);
+        return 0;
+    }
+
+    // Send soft reset command first
+    ret = i2c_write_dt(&cfg->bus, &reset_cmd, 1);
+    if (ret != 0) {
+        LOG_ERR("%s: reset failed (%d)", dev->name, ret);
+        return ret;
+    }
+    k_msleep(AHT10_RESET_TIME_MS);
+
+    // AHT20/AHT21 keep their calibration through a reset and only need
+    // the init command if it was lost. An unconfirmed AHT20 gets it
+    // anyway: refusing it is what gives a misdetected AHT10 away.
+    status = 0;
+    if (data->variant == AHT10_VARIANT_AHT20 &&
+        (data->variant_confirmed || cfg->variant != AHT10_VARIANT_UNKNOWN)) {
+        ret = aht10_read_status(dev, &status);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    if (!(status & AHT10_STATUS_CALIBRATED)) {
+        ret = aht10_send_init(dev, &status);
+
+        // A detected AHT20 that refuses its init command, before it ever
+        // worked, is an AHT10 that matched the CRC by chance
+        if (data->variant == AHT10_VARIANT_AHT20 &&
+            cfg->variant == AHT10_VARIANT_UNKNOWN && !data->variant_confirmed &&
+            (ret != 0 || !(status & AHT10_STATUS_CALIBRATED))) {
+            LOG_WRN("%s: AHT20 init failed, trying AHT10", dev->name);
+            aht10_set_variant(dev, AHT10_VARIANT_AHT10);
+            ret = aht10_send_init(dev, &status);
+        }
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    // Check if sensor is calibrated
+    if (!(status & AHT10_STATUS_CALIBRATED)) {
+        LOG_ERR("%s: not calibrated (status: 0x%02X)", dev->name, status);
+        return -EIO;
+    }
+
+    data->variant_confirmed = true;
+    LOG_INF("%s: initialized (status: 0x%02X)", dev->name, status);
+    return 0;
+}
+
+static int aht10_init(const struct device *dev)
+{
+    const struct aht10_config *cfg = dev->config;
+    struct aht10_data *data = dev->data;
+
+    data->dev = dev;
+    data->state = AHT10_STATE_IDLE;
+    data->variant = cfg->variant;
+    data->conversion_time_ms = (cfg->conversion_time_ms != 0) ?
+                               cfg->conversion_time_ms : AHT10_CONVERSION_TIME_MS;
+    data->workq = &k_sys_work_q;
+    data->backoff_ms = CONFIG_AHT10_RECOVERY_BACKOFF_MIN_MS;
+    data->retry_at = sys_timepoint_calc(K_NO_WAIT);
+    k_work_init_delayable(&data->work, aht10_work_handler);
+    k_poll_signal_init(&data->signal);
+
+    if (!i2c_is_ready_dt(&cfg->bus)) {
+        LOG_ERR("%s: I2C bus %s not ready", dev->name, cfg->bus.bus->name);
+        return -ENODEV;
+    }
+
+    // A sensor that doesn't answer at boot (brown-out, bus held low, not
+    // plugged in yet) is recovered by the first trigger instead of
+    // leaving the device unusable until the next reset
+    if (aht10_setup(dev, !IS_ENABLED(CONFIG_AHT10_FAST_INIT)) != 0) {
+        LOG_WRN("%s: will retry on the first measurement", dev->name);
+        data->faulted = true;
+    }
+
+    return 0;
+}
+
+#define AHT10_DEFINE(inst)                                                   \
+    static struct aht10_data aht10_data_##inst;                              \
+                                                                             \
+    static const struct aht10_config aht10_config_##inst = {                 \
+        .bus = I2C_DT_SPEC_INST_GET(inst),                                   \
+        .variant = DT_INST_ENUM_IDX(inst, variant),                          \
+        .conversion_time_ms = DT_INST_PROP(inst, conversion_time_ms),        \
+        .poll_interval_ms = DT_INST_PROP(inst, poll_interval_ms),            \
+        .busy_timeout_ms = DT_INST_PROP(inst, busy_timeout_ms),              \
+    };                                                                       \
+                                                                             \
+    SENSOR_DEVICE_DT_INST_DEFINE(inst, aht10_init, NULL, &aht10_data_##inst, \
+                                 &aht10_config_##inst, POST_KERNEL,          \
+                                 CONFIG_AHT10_INIT_PRIORITY,                 \
+                                 &aht10_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(AHT10_DEFINE)
@@ -0,0 +1,72 @@
+// aht10.h - AHT10 driver internals shared with the emulator
+#ifndef AHT10_AHT10_H_
+#define AHT10_AHT10_H_
+
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+#include <app/drivers/sensor/aht10.h>
+
+// AHT10 Commands (the trigger command is public, see app/drivers/sensor/aht10.h)
+#define AHT10_CMD_INIT          0xE1
+#define AHT20_CMD_INIT          0xBE    // AHT20/AHT21 take this one instead
+#define AHT10_CMD_SOFT_RESET    0xBA
+#define AHT10_STATUS_BUSY       0x80
+#define AHT10_STATUS_CALIBRATED 0x08
+
+// Timings from the datasheet
+#define AHT10_RESET_TIME_MS     20
+#define AHT10_INIT_TIME_MS      10
+
+// Conversion times from the datasheets, for conversion-time-ms = 0. The
+// AHT20/AHT21 datasheets ask for the same 80 ms wait as the AHT10's
+// 75 ms typical plus margin; the busy polls cover anything longer.
+#define AHT10_CONVERSION_TIME_MS 80
+#define AHT20_CONVERSION_TIME_MS 80
+
+// AHT20/AHT21: the AHT10_DATA_LEN frame plus a CRC-8 over it
+// (polynomial 0x31, initial value 0xFF)
+#define AHT20_DATA_LEN          7
+
+// Upper bound for a blocking sensor_sample_fetch()
+#define AHT10_FETCH_TIMEOUT     K_MSEC(500)
+
+struct aht10_config {
+    struct i2c_dt_spec bus;
+    enum aht10_variant variant;     // AHT10_VARIANT_UNKNOWN: detect at boot
+    uint16_t conversion_time_ms;    // 0: the variant's default
+    uint16_t poll_interval_ms;
+    uint16_t busy_timeout_ms;
+};
+
+struct aht10_data {
+    const struct device *dev;
+    struct k_work_delayable work;
+    struct k_work_q *workq;     // Queue the state machine runs on
+    struct k_poll_signal signal;
+    struct k_spinlock lock;
+    enum aht10_state state;
+    enum aht10_variant variant;
+    uint16_t conversion_time_ms;
+    int result;
+    struct aht10_sample sample;
+    struct aht10_sample last;   // Latest sample_fetch() result
+    aht10_callback_t cb;
+    void *user_data;
+    struct aht10_bus_stats bus_last;
+    struct aht10_bus_stats bus_total;
+    k_timepoint_t deadline;     // Busy polls give up after this
+    bool faulted;               // Recover before the next trigger
+    uint32_t backoff_ms;        // Wait after the next failed recovery
+    k_timepoint_t retry_at;     // No recovery attempt before this
+    struct aht10_fault_stats faults;
+    bool reset_skipped;         // Boot setup found the sensor calibrated
+    bool variant_confirmed;     // Init or a checked frame worked with the variant
+#ifdef CONFIG_LATENCY_PROBES
+    uint32_t trigger_cycles;    // When the trigger command went out
+#endif
+};
+
+// CRC-8 of an AHT20/AHT21 frame, table driven
+uint8_t aht10_crc8(const uint8_t *buf, size_t len);
+
+#endif // AHT10_AHT10_H_
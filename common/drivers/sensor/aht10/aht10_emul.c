@@ -0,0 +1,334 @@
+// aht10_emul.c - Emulated AHT10 on an emulated I2C bus
+//
+// Models the command set used by the driver (soft reset, init, trigger)
+// and a conversion that keeps the BUSY flag set for a configurable time.
+// Reads on a bus clocked faster than the part keeps up with come back
+// garbled. With CONFIG_AHT10_EMUL_AHT20 it is an AHT20/AHT21 instead: 0xBE
+// init, calibration kept through a reset and a CRC-8 after the frame.
+// Faults can be injected: NAKed transfers, a BUSY flag that stays set
+// until a soft reset, and corrupted AHT20 frames. A part can also be
+// unplugged, which NAKs everything including address probes. Readings can be set
+// through the generic emul_sensor backend API.
+
+#define DT_DRV_COMPAT aosong_aht10
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/logging/log.h>
+#include <app/drivers/sensor/aht10_emul.h>
+
+#include "aht10.h"
+
+LOG_MODULE_REGISTER(aht10_emul, CONFIG_AHT10_LOG_LEVEL);
+
+// Default reading: 23.45 °C, 45.00 %RH
+#define AHT10_EMUL_DEFAULT_RAW_T    385090
+#define AHT10_EMUL_DEFAULT_RAW_RH   471860
+
+struct aht10_emul_data {
+    const struct device *bus;
+    uint8_t glitch;             // Varies the garbage on overclocked reads
+    bool calibrated;
+    bool measuring;
+    bool stuck_busy;            // BUSY until the next soft reset
+    bool unplugged;             // Not on the bus at all
+    uint32_t naks_pending;      // Transfers still to be NAKed
+    uint32_t transfers;
+    uint32_t triggers;
+    uint32_t frame_reads;       // Reads of a finished conversion
+    int64_t busy_until;
+    uint32_t busy_time_ms;
+    uint32_t raw_humidity;
+    uint32_t raw_temperature;
+};
+
+static uint8_t aht10_emul_status(struct aht10_emul_data *data)
+{
+    uint8_t status = 0;
+
+    if (data->stuck_busy ||
+        (data->measuring && k_uptime_get() < data->busy_until)) {
+        status |= AHT10_STATUS_BUSY;
+    }
+    if (data->calibrated) {
+        status |= AHT10_STATUS_CALIBRATED;
+    }
+
+    return status;
+}
+
+static bool aht10_emul_overclocked(struct aht10_emul_data *data)
+{
+    uint32_t config;
+
+    if (i2c_get_config(data->bus, &config) != 0) {
+        return false;
+    }
+
+    switch (I2C_SPEED_GET(config)) {
+    case I2C_SPEED_STANDARD:
+        return I2C_BITRATE_STANDARD > CONFIG_AHT10_EMUL_MAX_BITRATE;
+    case I2C_SPEED_FAST:
+        return I2C_BITRATE_FAST > CONFIG_AHT10_EMUL_MAX_BITRATE;
+    default:
+        return I2C_BITRATE_FAST_PLUS > CONFIG_AHT10_EMUL_MAX_BITRATE;
+    }
+}
+
+static void aht10_emul_read(struct aht10_emul_data *data, uint8_t *buf,
+                            uint32_t len)
+{
+    uint8_t frame[AHT20_DATA_LEN];
+    size_t frame_len = AHT10_DATA_LEN;
+
+    frame[0] = aht10_emul_status(data);
+    frame[1] = data->raw_humidity >> 12;
+    frame[2] = data->raw_humidity >> 4;
+    frame[3] = ((data->raw_humidity & 0x0F) << 4) |
+               ((data->raw_temperature >> 16) & 0x0F);
+    frame[4] = data->raw_temperature >> 8;
+    frame[5] = data->raw_temperature;
+
+    if (IS_ENABLED(CONFIG_AHT10_EMUL_AHT20)) {
+        frame[AHT10_DATA_LEN] = aht10_crc8(frame, AHT10_DATA_LEN);
+        frame_len = AHT20_DATA_LEN;
+
+        // The CRC no longer matches: a bit flipped on the wire
+        if (data->measuring && !(frame[0] & AHT10_STATUS_BUSY) &&
+            len >= AHT20_DATA_LEN && CONFIG_AHT10_EMUL_FAULT_CRC_EVERY > 0 &&
+            ++data->frame_reads % CONFIG_AHT10_EMUL_FAULT_CRC_EVERY == 0) {
+            frame[2] ^= BIT(data->frame_reads % 8);
+        }
+    }
+
+    // Reads past the end of the frame see an idle (pulled-up) bus
+    memset(buf, 0xFF, len);
+    memcpy(buf, frame, MIN(len, frame_len));
+
+    if (aht10_emul_overclocked(data)) {
+        for (uint32_t i = 0; i < len; i++) {
+            buf[i] ^= BIT((data->glitch + i) % 8);
+        }
+        data->glitch++;
+    }
+}
+
+static int aht10_emul_write(struct aht10_emul_data *data, const uint8_t *buf,
+                            uint32_t len)
+{
+    // Zero-length write: address probe from a bus scan
+    if (len == 0) {
+        return 0;
+    }
+
+    switch (buf[0]) {
+    case AHT10_CMD_SOFT_RESET:
+        // An AHT20's calibration survives a reset
+        data->calibrated = IS_ENABLED(CONFIG_AHT10_EMUL_AHT20);
+        data->measuring = false;
+        data->stuck_busy = false;
+        return 0;
+    case AHT10_CMD_INIT:
+    case AHT20_CMD_INIT:
+        // Each part only knows its own init command
+        if (len < 3 ||
+            IS_ENABLED(CONFIG_AHT10_EMUL_AHT20) != (buf[0] == AHT20_CMD_INIT)) {
+            return -EIO;
+        }
+        data->calibrated = true;
+        return 0;
+    case AHT10_CMD_TRIGGER:
+        if (len < 3) {
+            return -EIO;
+        }
+        data->measuring = true;
+        data->busy_until = k_uptime_get() + data->busy_time_ms;
+        data->triggers++;
+        if (CONFIG_AHT10_EMUL_FAULT_STUCK_BUSY_EVERY > 0 &&
+            data->triggers % CONFIG_AHT10_EMUL_FAULT_STUCK_BUSY_EVERY == 0) {
+            data->stuck_busy = true;
+        }
+        return 0;
+    default:
+        LOG_WRN("unknown command 0x%02X", buf[0]);
+        return -EIO;
+    }
+}
+
+static int aht10_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                               int num_msgs, int addr)
+{
+    struct aht10_emul_data *data = target->data;
+    int ret;
+
+    ARG_UNUSED(addr);
+
+    if (data->unplugged) {
+        return -EIO;
+    }
+
+    // A NAK aborts the whole transfer before any message is handled
+    data->transfers++;
+    if (data->naks_pending > 0) {
+        data->naks_pending--;
+        return -EIO;
+    }
+    if (CONFIG_AHT10_EMUL_FAULT_NAK_EVERY > 0 &&
+        data->transfers % CONFIG_AHT10_EMUL_FAULT_NAK_EVERY == 0) {
+        return -EIO;
+    }
+
+    for (int i = 0; i < num_msgs; i++) {
+        if (msgs[i].flags & I2C_MSG_READ) {
+            aht10_emul_read(data, msgs[i].buf, msgs[i].len);
+        } else {
+            ret = aht10_emul_write(data, msgs[i].buf, msgs[i].len);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void aht10_emul_set_busy_time(const struct emul *target, uint32_t busy_time_ms)
+{
+    struct aht10_emul_data *data = target->data;
+
+    data->busy_time_ms = busy_time_ms;
+}
+
+void aht10_emul_inject_naks(const struct emul *target, uint32_t count)
+{
+    struct aht10_emul_data *data = target->data;
+
+    data->naks_pending = count;
+}
+
+void aht10_emul_set_present(const struct emul *target, bool present)
+{
+    struct aht10_emul_data *data = target->data;
+
+    // Plugging a part back in powers it up again
+    if (present && data->unplugged) {
+        data->calibrated = true;
+        data->measuring = false;
+        data->stuck_busy = false;
+    }
+    data->unplugged = !present;
+}
+
+void aht10_emul_set_stuck_busy(const struct emul *target, bool stuck)
+{
+    struct aht10_emul_data *data = target->data;
+
+    data->stuck_busy = stuck;
+}
+
+void aht10_emul_set_raw(const struct emul *target, uint32_t raw_humidity,
+                        uint32_t raw_temperature)
+{
+    struct aht10_emul_data *data = target->data;
+
+    data->raw_humidity = raw_humidity & 0xFFFFF;
+    data->raw_temperature = raw_temperature & 0xFFFFF;
+}
+
+// Convert a q31 value with the given shift to micro-units
+static int64_t aht10_emul_q31_to_micro(q31_t value, int8_t shift)
+{
+    int64_t micro = (int64_t)value * 1000000;
+
+    return shift >= 0 ? (micro << shift) >> 31 : micro >> (31 - shift);
+}
+
+static uint32_t aht10_emul_clamp_raw(int64_t raw)
+{
+    return CLAMP(raw, 0, 0xFFFFF);
+}
+
+static int aht10_emul_set_channel(const struct emul *target,
+                                  struct sensor_chan_spec ch,
+                                  const q31_t *value, int8_t shift)
+{
+    struct aht10_emul_data *data = target->data;
+    int64_t micro = aht10_emul_q31_to_micro(*value, shift);
+
+    // Inverse of the driver conversion: 2^20 counts over the full range
+    switch (ch.chan_type) {
+    case SENSOR_CHAN_AMBIENT_TEMP:
+        data->raw_temperature =
+            aht10_emul_clamp_raw(((micro + 50000000) << 20) / 200000000);
+        return 0;
+    case SENSOR_CHAN_HUMIDITY:
+        data->raw_humidity = aht10_emul_clamp_raw((micro << 20) / 100000000);
+        return 0;
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static int aht10_emul_get_sample_range(const struct emul *target,
+                                       struct sensor_chan_spec ch,
+                                       q31_t *lower, q31_t *upper,
+                                       q31_t *epsilon, int8_t *shift)
+{
+    ARG_UNUSED(target);
+
+    // Values are q31 fractions of 2^shift; one LSB is the resolution
+    switch (ch.chan_type) {
+    case SENSOR_CHAN_AMBIENT_TEMP:
+        // -50..150 °C, 200/2^20 °C per count
+        *shift = 8;
+        *lower = (q31_t)(-50LL * (1LL << 31) / 256);
+        *upper = (q31_t)(150LL * (1LL << 31) / 256);
+        *epsilon = (q31_t)((200LL << 31) / 256 >> 20);
+        return 0;
+    case SENSOR_CHAN_HUMIDITY:
+        // 0..100 %RH, 100/2^20 %RH per count
+        *shift = 7;
+        *lower = 0;
+        *upper = (q31_t)(100LL * (1LL << 31) / 128);
+        *epsilon = (q31_t)((100LL << 31) / 128 >> 20);
+        return 0;
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static const struct emul_sensor_driver_api aht10_emul_sensor_api = {
+    .set_channel = aht10_emul_set_channel,
+    .get_sample_range = aht10_emul_get_sample_range,
+};
+
+static int aht10_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct aht10_emul_data *data = target->data;
+
+    data->bus = parent;
+
+    // Parts leave the factory with the calibration bit set
+    data->calibrated = true;
+    data->measuring = false;
+    data->busy_time_ms = CONFIG_AHT10_EMUL_BUSY_TIME_MS;
+    data->raw_humidity = AHT10_EMUL_DEFAULT_RAW_RH;
+    data->raw_temperature = AHT10_EMUL_DEFAULT_RAW_T;
+
+    return 0;
+}
+
+static const struct i2c_emul_api aht10_emul_bus_api = {
+    .transfer = aht10_emul_transfer,
+};
+
+#define AHT10_EMUL(n)                                                        \
+    static struct aht10_emul_data aht10_emul_data_##n;                       \
+    EMUL_DT_INST_DEFINE(n, aht10_emul_init, &aht10_emul_data_##n, NULL,      \
+                        &aht10_emul_bus_api, &aht10_emul_sensor_api)
+
+DT_INST_FOREACH_STATUS_OKAY(AHT10_EMUL)
@@ -0,0 +1,133 @@
+// aht10.h - Non-blocking measurement API for the AHT10 driver
+#ifndef APP_DRIVERS_SENSOR_AHT10_H_
+#define APP_DRIVERS_SENSOR_AHT10_H_
+
+#include <stdbool.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Measurement command and its two parameter bytes, and the frame read
+// back: status byte, 20-bit humidity and 20-bit temperature. For code that
+// replays a sample's bus traffic (speed checks, benchmarks).
+#define AHT10_CMD_TRIGGER       0xAC
+#define AHT10_TRIGGER_PARAM0    0x33
+#define AHT10_TRIGGER_PARAM1    0x00
+#define AHT10_DATA_LEN          6
+
+// Measurement state machine:
+//   IDLE -> TRIGGERED -> (POLLING ->) READY -> IDLE
+enum aht10_state {
+    AHT10_STATE_IDLE,       // No measurement in flight
+    AHT10_STATE_TRIGGERED,  // Trigger sent, waiting out the conversion time
+    AHT10_STATE_POLLING,    // Conversion overran, polling the busy flag
+    AHT10_STATE_READY,      // Result waiting to be collected
+};
+
+// Supported parts. AHT21 speaks the AHT20 protocol: 0xBE init, and a
+// CRC-8 after the data frame.
+enum aht10_variant {
+    AHT10_VARIANT_UNKNOWN,  // Not detected yet (the sensor didn't answer)
+    AHT10_VARIANT_AHT10,
+    AHT10_VARIANT_AHT20,    // AHT20 or AHT21
+};
+
+// Raw 20-bit readings as returned by the sensor
+struct aht10_sample {
+    uint32_t raw_humidity;
+    uint32_t raw_temperature;
+    uint64_t timestamp_us;      // Conversion seen complete (sample_clock_now_us())
+};
+
+// I2C traffic counters. Bytes count payload only; each transaction also
+// puts one address byte on the wire.
+struct aht10_bus_stats {
+    uint32_t transactions;
+    uint32_t bytes;
+};
+
+// Fault and recovery counters since boot
+struct aht10_fault_stats {
+    uint32_t timeouts;          // Still busy at the busy-timeout-ms deadline
+    uint32_t bus_errors;        // Failed transfers (NAK, bus error, ...)
+    uint32_t bus_recoveries;    // i2c_recover_bus() calls
+    uint32_t reinits;           // Successful re-initializations
+    uint32_t reinit_failures;   // Failed ones (each doubles the backoff)
+    uint32_t crc_errors;        // AHT20/AHT21 frames that failed the CRC
+};
+
+// Integer conversions of the raw readings, rounded to the nearest 0.01.
+// Full scale is 2^20 counts, so x * 20000 / 2^20 and x * 10000 / 2^20
+// reduce to x * 625 >> 15 and x * 625 >> 16, which fit in 32 bits.
+static inline int32_t aht10_raw_to_centi_celsius(uint32_t raw_temperature)
+{
+    return (int32_t)((raw_temperature * 625U + (1U << 14)) >> 15) - 5000;
+}
+
+static inline int32_t aht10_raw_to_centi_percent(uint32_t raw_humidity)
+{
+    return (int32_t)((raw_humidity * 625U + (1U << 15)) >> 16);
+}
+
+// Completion callback, called from the driver's work queue with the result
+// of the measurement (0 or a negative errno). Keep it short.
+typedef void (*aht10_callback_t)(const struct device *dev, int result,
+                                 void *user_data);
+
+// Start a measurement and return immediately. The result is reported
+// through @p cb (may be NULL) and the device's poll signal.
+// Returns -EBUSY if a measurement is already in flight.
+// After a failed measurement the sensor is re-initialized first (bus
+// recovery, soft reset, init); while that keeps failing, attempts are
+// spaced out with exponential backoff and this returns -EAGAIN without
+// touching the bus.
+int aht10_trigger(const struct device *dev, aht10_callback_t cb,
+                  void *user_data);
+
+// Fetch the result of a finished measurement and return to IDLE.
+// Returns -EAGAIN while the conversion is still running, -ENODATA if
+// nothing was triggered, or the error the measurement ended with.
+int aht10_collect(const struct device *dev, struct aht10_sample *sample);
+
+// Run this sensor's state machine (bus polls, readout, callback) on
+// @p queue instead of the system work queue; NULL restores the default.
+// Returns -EBUSY while a measurement is in flight.
+int aht10_set_work_queue(const struct device *dev, struct k_work_q *queue);
+
+// Poll signal raised (with the measurement result) on completion.
+// Use it with k_poll() to wait on several sensors at once.
+struct k_poll_signal *aht10_get_signal(const struct device *dev);
+
+// Current state of the measurement state machine
+enum aht10_state aht10_get_state(const struct device *dev);
+
+// Raw readings behind the last successful sensor_sample_fetch()
+void aht10_get_raw(const struct device *dev, struct aht10_sample *sample);
+
+// Bus traffic of the most recent measurement (trigger to collect) and
+// the running total since boot. Either pointer may be NULL.
+void aht10_get_bus_stats(const struct device *dev, struct aht10_bus_stats *last,
+                         struct aht10_bus_stats *total);
+
+// Fault and recovery counters
+void aht10_get_fault_stats(const struct device *dev, struct aht10_fault_stats *stats);
+
+// Detected (or devicetree-selected) part
+enum aht10_variant aht10_get_variant(const struct device *dev);
+
+// Whether the boot setup found the sensor calibrated and skipped the reset
+// (CONFIG_AHT10_FAST_INIT)
+bool aht10_reset_skipped(const struct device *dev);
+
+// Convenience wrapper: trigger, sleep until done, collect.
+int aht10_read(const struct device *dev, struct aht10_sample *sample,
+               k_timeout_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_DRIVERS_SENSOR_AHT10_H_
@@ -0,0 +1,32 @@
+// aht10_emul.h - Test hooks for the emulated AHT10
+#ifndef APP_DRIVERS_SENSOR_AHT10_EMUL_H_
+#define APP_DRIVERS_SENSOR_AHT10_EMUL_H_
+
+#include <stdbool.h>
+#include <zephyr/drivers/emul.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set how long the sensor stays BUSY after each trigger command
+void aht10_emul_set_busy_time(const struct emul *target, uint32_t busy_time_ms);
+
+// NAK the next @p count transfers, as a sensor that dropped off the bus
+void aht10_emul_inject_naks(const struct emul *target, uint32_t count);
+
+// Unplug the sensor (every transfer and probe is NAKed) or plug it back in
+void aht10_emul_set_present(const struct emul *target, bool present);
+
+// Keep the BUSY flag set, as a hung conversion; a soft reset clears it
+void aht10_emul_set_stuck_busy(const struct emul *target, bool stuck);
+
+// Set the raw 20-bit values returned by the next measurements
+void aht10_emul_set_raw(const struct emul *target, uint32_t raw_humidity,
+                        uint32_t raw_temperature);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_DRIVERS_SENSOR_AHT10_EMUL_H_
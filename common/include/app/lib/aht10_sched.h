@@ -0,0 +1,66 @@
+// aht10_sched.h - Multi-bus, multi-sensor AHT10 acquisition scheduler
+#ifndef APP_LIB_AHT10_SCHED_H_
+#define APP_LIB_AHT10_SCHED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <app/drivers/sensor/aht10.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct aht10_sched_sensor {
+    const struct device *dev;
+    const struct device *bus;   // Sensors sharing a bus share a worker
+    uint16_t addr;              // For bus-level checks (speed negotiation)
+};
+
+// Initializer entries for every enabled aosong,aht10 node:
+//   static const struct aht10_sched_sensor sensors[] = {
+//       AHT10_SCHED_SENSORS_DT
+//   };
+#define AHT10_SCHED_SENSOR_DT(node_id)                                       \
+    {.dev = DEVICE_DT_GET(node_id), .bus = DEVICE_DT_GET(DT_BUS(node_id)),   \
+     .addr = DT_REG_ADDR(node_id)},
+
+#define AHT10_SCHED_SENSORS_DT                                               \
+    DT_FOREACH_STATUS_OKAY(aosong_aht10, AHT10_SCHED_SENSOR_DT)
+
+// Outcome of one sensor in a round
+struct aht10_sched_result {
+    int err;                    // 0 or the measurement's negative errno
+    struct aht10_sample sample;
+};
+
+struct aht10_sched_stats {
+    uint32_t rounds;
+    uint32_t samples;           // Successful readings
+    uint32_t errors;            // Failed or timed-out readings
+    uint32_t last_round_us;     // First trigger to last result
+    uint32_t max_round_us;      // Worst round since boot
+    uint32_t samples_per_sec;   // Throughput of the last round
+};
+
+// Assign the sensors to per-bus workers. @p sensors must stay valid.
+// Returns -ENOMEM if there are more sensors or buses than configured.
+int aht10_sched_init(const struct aht10_sched_sensor *sensors, size_t count);
+
+// Number of distinct buses found by aht10_sched_init()
+size_t aht10_sched_bus_count(void);
+
+// Run one round: trigger every sensor, then wait up to @p timeout for all
+// of them. @p results has one entry per sensor, in the order given to
+// aht10_sched_init(). Returns the number of successful readings.
+int aht10_sched_run(struct aht10_sched_result *results, k_timeout_t timeout);
+
+void aht10_sched_get_stats(struct aht10_sched_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_AHT10_SCHED_H_
@@ -0,0 +1,49 @@
+// bench.h - Machine-readable benchmark results on the console
+//
+// Each result is one line, "BENCH <metric> <value>", with the unit in the
+// metric name (e.g. "aht10.round_max_us"). Twister records these lines
+// (harness_config: record) into twister.json and recording.csv, and
+// scripts/bench_compare.py diffs two runs.
+#ifndef APP_LIB_BENCH_H_
+#define APP_LIB_BENCH_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/logging/log_ctrl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline void bench_report(const char *metric, uint32_t value)
+{
+    printk("BENCH %s %u\n", metric, value);
+}
+
+// Microseconds since boot, for init-path timings
+static inline uint32_t bench_uptime_us(void)
+{
+    return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+// Bytes waiting in the deferred log buffer (0 with immediate logging).
+// The difference around a call, with the log thread unable to run in
+// between, is what that call logged.
+static inline uint32_t bench_log_pending(void)
+{
+#ifdef CONFIG_LOG_MODE_DEFERRED
+    uint32_t size, used;
+
+    if (log_mem_get_usage(&size, &used) == 0) {
+        return used;
+    }
+#endif
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_BENCH_H_
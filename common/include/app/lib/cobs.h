@@ -0,0 +1,24 @@
+// cobs.h - Consistent Overhead Byte Stuffing
+#ifndef APP_LIB_COBS_H_
+#define APP_LIB_COBS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Worst-case encoded size of @p len input bytes, excluding the delimiter
+#define COBS_MAX_ENCODED_LEN(len) ((len) + ((len) / 254) + 1)
+
+// Encode @p len bytes into @p dst, which must hold COBS_MAX_ENCODED_LEN(len).
+// The output contains no zero bytes; the caller appends the 0x00 delimiter.
+// Returns the encoded length.
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_COBS_H_
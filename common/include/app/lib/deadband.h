@@ -0,0 +1,43 @@
+// deadband.h - Report-on-change with deadband and heartbeat
+#ifndef APP_LIB_DEADBAND_H_
+#define APP_LIB_DEADBAND_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct deadband_stats {
+    uint32_t sent;          // Readings reported
+    uint32_t suppressed;    // Readings held back inside the deadband
+    uint32_t heartbeats;    // Reports forced by the silent interval
+};
+
+// One gate per sensor. Values are in hundredths of °C / %RH.
+struct deadband {
+    int32_t temp_band;
+    int32_t humid_band;
+    int64_t heartbeat_ms;
+    int32_t last_temp;      // Last reported values
+    int32_t last_humid;
+    int64_t last_ms;        // When they were reported
+    bool primed;            // Something has been reported yet
+    struct deadband_stats stats;
+};
+
+void deadband_init(struct deadband *db, int32_t temp_band, int32_t humid_band,
+                   uint32_t heartbeat_ms);
+
+// Decide whether a reading taken at @p now_ms should be reported. A
+// reading is reported when either channel moved by at least its band
+// since the last report, or when the heartbeat interval has passed.
+bool deadband_check(struct deadband *db, int32_t temp, int32_t humid,
+                    int64_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_DEADBAND_H_
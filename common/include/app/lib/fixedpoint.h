@@ -0,0 +1,105 @@
+// fixedpoint.h - Integer-only formatting of centi-unit values
+#ifndef APP_LIB_FIXEDPOINT_H_
+#define APP_LIB_FIXEDPOINT_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest output: "-21474836.48" plus NUL
+#define FIXEDPOINT_CENTI_STR_LEN 13
+
+// Format and arguments for a centi value in a log message, so the
+// formatting is left to the log backend (or the host, with dictionary
+// logging): LOG_INF("T: " FIXEDPOINT_CENTI_FMT, FIXEDPOINT_CENTI_ARGS(t))
+#define FIXEDPOINT_CENTI_FMT "%s%u.%02u"
+#define FIXEDPOINT_CENTI_ARGS(centi)                                        \
+    ((centi) < 0 ? "-" : ""),                                               \
+    (unsigned int)(fixedpoint_centi_mag(centi) / 100),                      \
+    (unsigned int)(fixedpoint_centi_mag(centi) % 100)
+
+static inline uint32_t fixedpoint_centi_mag(int32_t centi)
+{
+    return centi < 0 ? -(uint32_t)centi : (uint32_t)centi;
+}
+
+// Write @p centi (hundredths) as "[-]I.FF" into @p buf, which must hold
+// FIXEDPOINT_CENTI_STR_LEN bytes. Returns the string length.
+static inline int fixedpoint_centi_to_str(int32_t centi, char *buf)
+{
+    char tmp[FIXEDPOINT_CENTI_STR_LEN];
+    uint32_t mag = centi < 0 ? -(uint32_t)centi : (uint32_t)centi;
+    int n = 0;
+    int len = 0;
+
+    // Digits come out least significant first; always at least "0.00"
+    do {
+        tmp[n++] = '0' + (mag % 10);
+        mag /= 10;
+        if (n == 2) {
+            tmp[n++] = '.';
+        }
+    } while (mag != 0 || n < 4);
+
+    if (centi < 0) {
+        buf[len++] = '-';
+    }
+    while (n > 0) {
+        buf[len++] = tmp[--n];
+    }
+    buf[len] = '\0';
+
+    return len;
+}
+
+// Parse "[-]I[.F[F]]" into hundredths; further decimals are truncated.
+// Returns 0, or -EINVAL if @p str is not a number or doesn't fit.
+static inline int fixedpoint_str_to_centi(const char *str, int32_t *centi)
+{
+    bool negative = (*str == '-');
+    int64_t value = 0;
+    int decimals = -1;
+
+    if (*str == '-' || *str == '+') {
+        str++;
+    }
+    if (*str == '\0') {
+        return -EINVAL;
+    }
+
+    for (; *str != '\0'; str++) {
+        if (*str == '.' && decimals < 0) {
+            decimals = 0;
+        } else if (*str < '0' || *str > '9') {
+            return -EINVAL;
+        } else if (decimals < 2) {
+            value = value * 10 + (*str - '0');
+            decimals += (decimals >= 0);
+            if (value > (int64_t)INT32_MAX) {
+                return -EINVAL;
+            }
+        }
+    }
+
+    // Scale whatever decimals were given up to hundredths
+    for (decimals = MAX(decimals, 0); decimals < 2; decimals++) {
+        value *= 10;
+    }
+    if (value > (int64_t)INT32_MAX) {
+        return -EINVAL;
+    }
+
+    *centi = negative ? -(int32_t)value : (int32_t)value;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_FIXEDPOINT_H_
@@ -0,0 +1,68 @@
+// i2c_scan.h - Fast I2C bus scanner with a presence bitmap
+#ifndef APP_LIB_I2C_SCAN_H_
+#define APP_LIB_I2C_SCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Non-reserved 7-bit address range
+#define I2C_SCAN_ADDR_FIRST 0x08
+#define I2C_SCAN_ADDR_LAST  0x77
+
+struct i2c_scan_result {
+    uint32_t present[4];    // Bit n set: device ACKed address n
+    uint8_t count;          // Number of devices found
+    uint8_t probes;         // Number of addresses probed
+    uint32_t duration_us;   // Wall time of the whole scan
+    uint32_t bitrate;       // Bus speed during the scan, 0 if unknown
+};
+
+static inline bool i2c_scan_is_present(const struct i2c_scan_result *result,
+                                       uint8_t addr)
+{
+    return (result->present[addr / 32] & BIT(addr % 32)) != 0;
+}
+
+// Probe a single address with a zero-length write. Returns true on ACK.
+bool i2c_scan_probe(const struct device *bus, uint8_t addr);
+
+// Probe every address from I2C_SCAN_ADDR_FIRST to I2C_SCAN_ADDR_LAST
+int i2c_scan_bus(const struct device *bus, struct i2c_scan_result *result);
+
+// Print the classic 16-column address table and a timing summary
+void i2c_scan_print(const struct i2c_scan_result *result);
+
+// Incremental presence monitor: each cycle re-probes only the addresses
+// known to be present plus a small round-robin slice of the empty ones,
+// so bus occupancy per cycle stays small and nearly constant.
+struct i2c_scan_monitor {
+    const struct device *bus;
+    struct i2c_scan_result known;   // Current presence bitmap
+    uint8_t slice;                  // Empty addresses probed per cycle
+    uint8_t cursor;                 // Next empty address to sweep
+    uint8_t probes;                 // Probes issued in the last cycle
+    uint32_t duration_us;           // Bus time of the last cycle
+};
+
+// Called for every change seen by i2c_scan_monitor_poll()
+typedef void (*i2c_scan_event_cb_t)(uint8_t addr, bool present, void *user_data);
+
+// Run a full scan to seed the bitmap; @p slice is clamped to at least 1
+int i2c_scan_monitor_init(struct i2c_scan_monitor *mon, const struct device *bus,
+                          uint8_t slice);
+
+// Run one monitor cycle. Returns the number of events reported.
+int i2c_scan_monitor_poll(struct i2c_scan_monitor *mon, i2c_scan_event_cb_t cb,
+                          void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_I2C_SCAN_H_
@@ -0,0 +1,65 @@
+// i2c_speed.h - I2C bus speed negotiation with per-bus fallback
+#ifndef APP_LIB_I2C_SPEED_H_
+#define APP_LIB_I2C_SPEED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest integrity-check read
+#define I2C_SPEED_CHECK_MAX_LEN 16
+
+// A device that has to keep working at the negotiated speed
+struct i2c_speed_target {
+    uint16_t addr;
+    uint8_t check_len;      // Bytes per integrity-check read (0: probe only)
+};
+
+struct i2c_speed_result {
+    uint32_t speed;         // I2C_SPEED_* the bus was left at
+    uint32_t bitrate;       // The same in Hz
+    uint8_t tried;          // Speeds the controller accepted and we checked
+    uint8_t fallbacks;      // Of those, rejected by a target
+    uint16_t failed_addr;   // Target behind the last fallback
+    int err;                // Its error, 0 if nothing fell back
+};
+
+struct i2c_speed_bench {
+    uint32_t bitrate;
+    uint32_t transfers_per_sec;
+    uint32_t sequence_us;   // Average time of one run of the sequence
+};
+
+// I2C_SPEED_* to Hz, 0 if unknown
+uint32_t i2c_speed_to_bitrate(uint32_t speed);
+
+// Check a target at the bus's current speed: an address probe, then
+// CONFIG_I2C_SPEED_CHECK_READS reads of check_len bytes that must all
+// match and must not be all ones (nobody driving the bus).
+// Returns 0, -ENXIO on a missing ACK or -EIO on inconsistent data.
+int i2c_speed_check(const struct device *bus, const struct i2c_speed_target *target);
+
+// Try @p max_speed and every slower speed down to I2C_SPEED_STANDARD and
+// keep the first one all @p targets pass i2c_speed_check() at. Speeds
+// the controller rejects are skipped. If even standard mode fails, the
+// bus is left there and the error is returned.
+int i2c_speed_negotiate(const struct device *bus, uint32_t max_speed,
+                        const struct i2c_speed_target *targets, size_t count,
+                        struct i2c_speed_result *result);
+
+// Time @p reps runs of @p msgs at the bus's current speed, one
+// i2c_transfer() per message, the way sensor drivers issue them
+int i2c_speed_bench_run(const struct device *bus, uint16_t addr,
+                        struct i2c_msg *msgs, uint8_t num_msgs, uint32_t reps,
+                        struct i2c_speed_bench *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_I2C_SPEED_H_
@@ -0,0 +1,66 @@
+// latency.h - Per-stage latency probes feeding log2 histograms
+#ifndef APP_LIB_LATENCY_H_
+#define APP_LIB_LATENCY_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bucket i counts durations of [2^i, 2^(i+1)) cycles (bucket 0 also 0)
+#define LATENCY_BUCKETS 32
+
+// One histogram per stage. Recording is safe from any context; dumps
+// read without locking and may see a sample half-recorded.
+struct latency_hist {
+    const char *name;
+    uint32_t count;
+    uint32_t min;               // Cycles
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[LATENCY_BUCKETS];
+};
+
+#ifdef CONFIG_LATENCY_PROBES
+
+// Define a histogram at file scope; it shows up in latency_dump()
+#define LATENCY_HIST_DEFINE(_name)                                          \
+    STRUCT_SECTION_ITERABLE(latency_hist, _name) = {                        \
+        .name = #_name,                                                     \
+        .min = UINT32_MAX,                                                  \
+    }
+
+// Take a timestamp into a new local variable
+#define LATENCY_START(_var) uint32_t _var = k_cycle_get_32()
+
+// Record the time since @p _start in @p _hist
+#define LATENCY_END(_hist, _start)                                          \
+    latency_record(&(_hist), k_cycle_get_32() - (_start))
+
+void latency_record(struct latency_hist *hist, uint32_t cycles);
+
+// Print every histogram on the console
+void latency_dump(void);
+
+void latency_reset(void);
+
+#else
+
+// Probes compile to nothing: no section, no timestamps, no calls
+#define LATENCY_HIST_DEFINE(_name) extern int latency_unused_##_name
+#define LATENCY_START(_var) do { } while (0)
+#define LATENCY_END(_hist, _start) do { } while (0)
+
+static inline void latency_dump(void) {}
+static inline void latency_reset(void) {}
+
+#endif // CONFIG_LATENCY_PROBES
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_LATENCY_H_
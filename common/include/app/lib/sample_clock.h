@@ -0,0 +1,82 @@
+// sample_clock.h - Drift-free sampling schedule with jitter statistics
+#ifndef APP_LIB_SAMPLE_CLOCK_H_
+#define APP_LIB_SAMPLE_CLOCK_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Microseconds since boot, for sample timestamps. Uses the 64-bit cycle
+// counter where the system timer has one (both the BlackPill's SysTick and
+// native_sim do), so resolution is far below the kernel tick.
+static inline uint64_t sample_clock_now_us(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    return k_cyc_to_us_floor64(k_cycle_get_64());
+#else
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
+}
+
+// How well samples keep to the schedule. Lag is a sample's timestamp minus
+// the time of the tick it was taken for; the part that doesn't vary (the
+// conversion time) is lag_min_us, the jitter is lag_max_us - lag_min_us.
+struct sample_clock_stats {
+    uint32_t ticks;         // Ticks since the schedule was (re)started
+    uint32_t missed;        // Ticks that passed while the loop was busy
+    uint32_t samples;       // Timestamps checked against the schedule
+    uint32_t lag_min_us;
+    uint32_t lag_mean_us;
+    uint32_t lag_max_us;
+    uint32_t jitter_us;
+};
+
+struct sample_clock {
+    struct k_timer timer;
+    struct k_sem tick;          // Given on every expiry
+    atomic_t expiries;          // Counted in the timer's expiry function
+    atomic_t new_period_ms;     // Set by sample_clock_set_period()
+    int64_t anchor_ticks;       // Kernel tick of the first expiry
+    uint32_t period_ticks;
+    uint32_t ticks;             // Expiries the waiter has seen
+    uint32_t missed;
+    uint32_t samples;
+    uint32_t lag_min_us;
+    uint32_t lag_max_us;
+    uint64_t lag_sum_us;
+};
+
+// Start a schedule with a tick every @p period_ms, the first one right
+// away. Expiries are anchored to absolute kernel ticks, so time spent
+// between waits never accumulates into drift.
+void sample_clock_start(struct sample_clock *clk, uint32_t period_ms);
+
+// Change the period from any thread. The waiter restarts the schedule
+// from its next wakeup, which happens right away.
+void sample_clock_set_period(struct sample_clock *clk, uint32_t period_ms);
+
+// Wait for the next tick. If the loop overran, ticks that already passed
+// are counted as missed and the latest one is returned, rather than
+// running the loop several times back to back.
+// Returns 0, or -EAGAIN if @p timeout ran out first.
+int sample_clock_wait(struct sample_clock *clk, k_timeout_t timeout);
+
+// Scheduled time of the latest tick, on the sample_clock_now_us() scale
+uint64_t sample_clock_tick_us(const struct sample_clock *clk);
+
+// Check a sample timestamp (sample_clock_now_us() scale) taken for the
+// latest tick against the schedule
+void sample_clock_record(struct sample_clock *clk, uint64_t timestamp_us);
+
+void sample_clock_get_stats(const struct sample_clock *clk,
+                            struct sample_clock_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_SAMPLE_CLOCK_H_
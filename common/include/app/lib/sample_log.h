@@ -0,0 +1,58 @@
+// sample_log.h - Flash-backed store-and-forward sample log
+#ifndef APP_LIB_SAMPLE_LOG_H_
+#define APP_LIB_SAMPLE_LOG_H_
+
+#include <stdint.h>
+#include <app/lib/telemetry.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sample_log_stats {
+    uint32_t appended;      // Samples appended since boot
+    uint32_t chunks;        // Flash entries written since boot
+    uint32_t bytes;         // Encoded bytes since boot, open chunk included
+    uint32_t rotations;     // Oldest sectors dropped because the log was full
+    uint64_t append_us;     // Time spent appending, flash writes included
+};
+
+// Mount the log, erasing the partition if it doesn't hold a valid log, and
+// record a new boot: one more than the last boot count in the log, or 1
+// for a fresh log
+int sample_log_init(void);
+
+// Boot count that samples appended now are tagged with
+uint32_t sample_log_boot_count(void);
+
+// Add one sample. Only the sample's millisecond timestamp is stored, with
+// the boot count to tell boots apart. Writes to flash whenever a chunk
+// fills up or CONFIG_SAMPLE_LOG_FLUSH_INTERVAL_MS has passed since the
+// chunk's first sample, so it may block for a sector erase. A reset loses
+// the samples of the open chunk, at most that interval's worth and never
+// more than one chunk. All calls are thread-safe.
+int sample_log_append(const struct telemetry_sample *sample);
+
+// Write out the partially filled chunk, e.g. before a planned reset
+int sample_log_flush(void);
+
+// Called for every logged sample, oldest first, with the boot it was
+// taken in (its timestamp counts from that boot). Return non-zero to stop.
+typedef int (*sample_log_drain_cb_t)(const struct telemetry_sample *sample,
+                                     uint32_t boot, void *user_data);
+
+// Flush, replay the whole log through @p cb and clear it. The log is only
+// cleared if every sample was handed over. @p cb runs without the log's
+// lock held, so it may block (e.g. on the UART) while other threads keep
+// appending; samples that reach flash meanwhile are replayed as well.
+// Returns the number of samples replayed or a negative errno (-ESTALE if
+// the log was full and rotated during the replay).
+int sample_log_drain(sample_log_drain_cb_t cb, void *user_data);
+
+void sample_log_get_stats(struct sample_log_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_SAMPLE_LOG_H_
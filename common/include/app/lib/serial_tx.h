@@ -0,0 +1,50 @@
+// serial_tx.h - Non-blocking UART output through an IRQ-drained ring buffer
+#ifndef APP_LIB_SERIAL_TX_H_
+#define APP_LIB_SERIAL_TX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct serial_tx_stats {
+    uint32_t bytes_sent;     // Bytes handed to the UART FIFO
+    uint32_t overflows;      // Writes dropped because the ring was full
+    uint32_t bytes_dropped;  // Bytes lost to those overflows
+    uint32_t high_water;     // Peak ring occupancy in bytes
+};
+
+// Called from the UART ISR for every received byte
+typedef void (*serial_tx_rx_cb_t)(uint8_t c, void *user_data);
+
+// Attach the ring to an interrupt-driven UART
+int serial_tx_init(const struct device *uart);
+
+// Hand received bytes to @p cb (in ISR context); NULL turns RX off
+int serial_tx_set_rx_callback(serial_tx_rx_cb_t cb, void *user_data);
+
+// Queue @p len bytes and return immediately. The write is all-or-nothing:
+// returns @p len, or -ENOSPC (counted as an overflow) if it doesn't fit.
+int serial_tx_write(const void *data, size_t len);
+
+// Queue a NUL-terminated string
+int serial_tx_puts(const char *str);
+
+// Bytes still waiting in the ring
+size_t serial_tx_pending(void);
+
+// Wait until the ring has been handed to the UART, e.g. before
+// suspending it. Returns 0, or -EAGAIN on timeout.
+int serial_tx_flush(k_timeout_t timeout);
+
+void serial_tx_get_stats(struct serial_tx_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_SERIAL_TX_H_
@@ -0,0 +1,70 @@
+// stream_stats.h - Integer streaming filters and window statistics
+//
+// All values are plain int32_t in whatever unit the caller uses (the
+// apps use hundredths of °C / %RH). Nothing here allocates or uses
+// floating point.
+#ifndef APP_LIB_STREAM_STATS_H_
+#define APP_LIB_STREAM_STATS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest moving-average / median window
+#define STREAM_FILTER_MAX_TAPS  16
+
+enum stream_filter_type {
+    STREAM_FILTER_NONE,         // Pass-through
+    STREAM_FILTER_MOVING_AVG,   // Mean of the last N inputs
+    STREAM_FILTER_MEDIAN,       // Median of the last N inputs
+    STREAM_FILTER_EMA,          // y += (x - y) / 2^shift
+};
+
+struct stream_filter {
+    enum stream_filter_type type;
+    uint8_t taps;               // Window length, or the EMA shift
+    uint8_t count;              // Inputs held so far (up to taps)
+    uint8_t head;               // Next slot in hist[]
+    int32_t hist[STREAM_FILTER_MAX_TAPS];
+    int64_t acc;                // Window sum, or EMA state scaled by 2^shift
+};
+
+// @p param is the window length for MOVING_AVG/MEDIAN (clamped to
+// 1..STREAM_FILTER_MAX_TAPS) and the smoothing shift for EMA
+// (alpha = 1/2^param, clamped to 0..15).
+void stream_filter_init(struct stream_filter *f, enum stream_filter_type type,
+                        uint8_t param);
+
+// Feed one input and return the filtered value
+int32_t stream_filter_update(struct stream_filter *f, int32_t x);
+
+// Running statistics over a reporting window. Mean and M2 are kept in
+// Q16 fixed point, so Welford's update stays accurate without floats.
+struct stream_stats {
+    uint32_t count;
+    int64_t mean_q16;
+    int64_t m2_q16;             // Sum of squared deviations, Q16
+    int32_t min;
+    int32_t max;
+};
+
+void stream_stats_reset(struct stream_stats *s);
+
+void stream_stats_add(struct stream_stats *s, int32_t x);
+
+// Mean, rounded to the nearest unit
+int32_t stream_stats_mean(const struct stream_stats *s);
+
+// Sample variance in units squared (0 for fewer than two inputs)
+uint32_t stream_stats_variance(const struct stream_stats *s);
+
+// Sample standard deviation, rounded to the nearest unit
+uint32_t stream_stats_stddev(const struct stream_stats *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_STREAM_STATS_H_
@@ -0,0 +1,90 @@
+// telemetry.h - Compact binary sample frames
+//
+// Frame on the wire: COBS(payload) followed by a 0x00 delimiter.
+// Sample payload (little-endian, 18 bytes):
+//   [0]      frame type (TELEMETRY_TYPE_SAMPLE)
+//   [1..2]   sequence number, wraps at 65536
+//   [3..10]  timestamp in microseconds since boot
+//   [11..15] raw humidity (bits 39..20) and raw temperature (bits 19..0)
+//   [16..17] CRC-16/CCITT-FALSE over bytes 0..15
+//
+// Log sample payload (little-endian, 20 bytes), replayed from flash:
+//   [0]      frame type (TELEMETRY_TYPE_LOG_SAMPLE)
+//   [1..2]   sequence number, counted apart from live samples
+//   [3..4]   boot count the sample was taken in, wraps at 65536
+//   [5..12]  timestamp in microseconds since that boot
+//   [13..17] raw readings, as in a sample
+//   [18..19] CRC-16/CCITT-FALSE over bytes 0..17
+//
+// Aggregate payload (little-endian, 35 bytes), one per oversampling window:
+//   [0]      frame type (TELEMETRY_TYPE_AGGREGATE)
+//   [1..2]   sequence number
+//   [3..10]  timestamp of the window's last sample in microseconds
+//   [11..12] number of samples in the window
+//   [13..22] temperature: filtered, mean, min, max (int16), stddev (uint16)
+//   [23..32] humidity: same layout
+//   [33..34] CRC-16/CCITT-FALSE over bytes 0..32
+// All aggregate values are in hundredths of °C / %RH.
+#ifndef APP_LIB_TELEMETRY_H_
+#define APP_LIB_TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <app/lib/cobs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_TYPE_SAMPLE       0x01
+#define TELEMETRY_TYPE_AGGREGATE    0x02
+#define TELEMETRY_TYPE_LOG_SAMPLE   0x03
+
+#define TELEMETRY_PAYLOAD_LEN       18
+#define TELEMETRY_LOG_PAYLOAD_LEN   20
+#define TELEMETRY_AGGREGATE_LEN     35
+
+// Largest encoded frame of either type, delimiter included
+#define TELEMETRY_FRAME_MAX_LEN     (COBS_MAX_ENCODED_LEN(TELEMETRY_AGGREGATE_LEN) + 1)
+
+struct telemetry_sample {
+    uint64_t timestamp_us;
+    uint32_t raw_humidity;      // 20-bit
+    uint32_t raw_temperature;   // 20-bit
+};
+
+// Window statistics of one channel, in hundredths
+struct telemetry_channel_stats {
+    int32_t value;              // Filter output at the end of the window
+    int32_t mean;
+    int32_t min;
+    int32_t max;
+    uint32_t stddev;
+};
+
+struct telemetry_aggregate {
+    uint64_t timestamp_us;
+    uint16_t count;
+    struct telemetry_channel_stats temperature;
+    struct telemetry_channel_stats humidity;
+};
+
+// Encode one sample into @p out (at least TELEMETRY_FRAME_MAX_LEN bytes).
+// Returns the number of bytes to send, delimiter included.
+size_t telemetry_encode_sample(const struct telemetry_sample *sample,
+                               uint16_t seq, uint8_t *out);
+
+// Encode one sample replayed from a log, taken in boot @p boot, otherwise
+// like telemetry_encode_sample()
+size_t telemetry_encode_log_sample(const struct telemetry_sample *sample,
+                                   uint32_t boot, uint16_t seq, uint8_t *out);
+
+// Encode one window aggregate the same way. Values are clamped to 16 bits.
+size_t telemetry_encode_aggregate(const struct telemetry_aggregate *agg,
+                                  uint16_t seq, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_LIB_TELEMETRY_H_
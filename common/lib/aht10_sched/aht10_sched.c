@@ -0,0 +1,179 @@
+// aht10_sched.c - Multi-bus, multi-sensor AHT10 acquisition scheduler
+//
+// A round triggers every sensor back to back and only then waits, so all
+// conversion windows overlap: N sensors take about one conversion time
+// instead of N. Each bus has its own work queue thread that runs the
+// driver state machines (busy polls and readout) of the sensors on it, so
+// a slow or busy bus doesn't hold up the others.
+//
+// Completions are tracked per sensor: each callback carries the round and
+// the sensor's index and records that round as the sensor's latest, and a
+// round ends once every sensor it triggered has recorded it. A measurement
+// from an earlier round that finishes late records its own round, so it
+// isn't counted against the next one.
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <app/lib/aht10_sched.h>
+
+LOG_MODULE_REGISTER(aht10_sched, LOG_LEVEL_INF);
+
+K_THREAD_STACK_ARRAY_DEFINE(sched_stacks, CONFIG_AHT10_SCHED_MAX_BUSES,
+                            CONFIG_AHT10_SCHED_STACK_SIZE);
+
+static struct k_work_q sched_queues[CONFIG_AHT10_SCHED_MAX_BUSES];
+static const struct device *sched_buses[CONFIG_AHT10_SCHED_MAX_BUSES];
+static size_t sched_bus_count;
+
+static const struct aht10_sched_sensor *sched_sensors;
+static size_t sched_sensor_count;
+
+// Callback tag: round number (low 16 bits) above the sensor index
+#define SCHED_TAG(round, i)     ((void *)(uintptr_t)((((round) & 0xFFFF) << 8) | (i)))
+#define SCHED_TAG_ROUND(tag)    ((atomic_val_t)((uintptr_t)(tag) >> 8))
+#define SCHED_TAG_INDEX(tag)    ((size_t)((uintptr_t)(tag) & 0xFF))
+
+static uint32_t sched_round;
+
+// Last round each sensor finished a measurement of
+static atomic_t sched_done_round[CONFIG_AHT10_SCHED_MAX_SENSORS];
+
+// Wakes the round after every completion
+static K_SEM_DEFINE(sched_done, 0, 1);
+
+static struct aht10_sched_stats sched_stats;
+
+static void aht10_sched_done(const struct device *dev, int result,
+                             void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(result);
+
+    atomic_set(&sched_done_round[SCHED_TAG_INDEX(user_data)],
+               SCHED_TAG_ROUND(user_data));
+    k_sem_give(&sched_done);
+}
+
+static struct k_work_q *aht10_sched_queue(const struct device *bus)
+{
+    struct k_work_queue_config cfg = {
+        .name = bus->name,
+    };
+    size_t i;
+
+    for (i = 0; i < sched_bus_count; i++) {
+        if (sched_buses[i] == bus) {
+            return &sched_queues[i];
+        }
+    }
+
+    if (sched_bus_count == CONFIG_AHT10_SCHED_MAX_BUSES) {
+        return NULL;
+    }
+
+    k_work_queue_start(&sched_queues[i], sched_stacks[i],
+                       K_THREAD_STACK_SIZEOF(sched_stacks[i]),
+                       CONFIG_AHT10_SCHED_THREAD_PRIORITY, &cfg);
+    sched_buses[i] = bus;
+    sched_bus_count++;
+
+    return &sched_queues[i];
+}
+
+int aht10_sched_init(const struct aht10_sched_sensor *sensors, size_t count)
+{
+    int ret;
+
+    if (count > CONFIG_AHT10_SCHED_MAX_SENSORS) {
+        LOG_ERR("%u sensors, only %u supported", (unsigned int)count,
+                CONFIG_AHT10_SCHED_MAX_SENSORS);
+        return -ENOMEM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        struct k_work_q *queue = aht10_sched_queue(sensors[i].bus);
+
+        if (queue == NULL) {
+            LOG_ERR("%s: more than %u buses", sensors[i].bus->name,
+                    CONFIG_AHT10_SCHED_MAX_BUSES);
+            return -ENOMEM;
+        }
+
+        ret = aht10_set_work_queue(sensors[i].dev, queue);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    sched_sensors = sensors;
+    sched_sensor_count = count;
+
+    LOG_INF("%u sensor(s) on %u bus(es)", (unsigned int)count,
+            (unsigned int)sched_bus_count);
+    return 0;
+}
+
+size_t aht10_sched_bus_count(void)
+{
+    return sched_bus_count;
+}
+
+int aht10_sched_run(struct aht10_sched_result *results, k_timeout_t timeout)
+{
+    k_timepoint_t deadline = sys_timepoint_calc(timeout);
+    uint32_t pending = 0;
+    uint32_t round = (sched_round++ % 0xFFFF) + 1;    // Never 0, the initial value
+    int ok = 0;
+    uint32_t start;
+
+    k_sem_reset(&sched_done);
+    start = k_cycle_get_32();
+
+    // Trigger everything first; each trigger is a single 3-byte write
+    for (size_t i = 0; i < sched_sensor_count; i++) {
+        results[i].err = aht10_trigger(sched_sensors[i].dev, aht10_sched_done,
+                                       SCHED_TAG(round, i));
+        if (results[i].err == 0) {
+            pending |= BIT(i);
+        }
+    }
+
+    // ...then wait for the conversions, which all run at the same time
+    while (pending != 0) {
+        for (size_t i = 0; i < sched_sensor_count; i++) {
+            if (atomic_get(&sched_done_round[i]) == (atomic_val_t)round) {
+                pending &= ~BIT(i);
+            }
+        }
+        if (pending == 0 ||
+            k_sem_take(&sched_done, sys_timepoint_timeout(deadline)) != 0) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < sched_sensor_count; i++) {
+        if (results[i].err == 0) {
+            results[i].err = aht10_collect(sched_sensors[i].dev,
+                                           &results[i].sample);
+        }
+        if (results[i].err == 0) {
+            ok++;
+        }
+    }
+
+    sched_stats.last_round_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    sched_stats.max_round_us = MAX(sched_stats.max_round_us, sched_stats.last_round_us);
+    sched_stats.samples_per_sec = (sched_stats.last_round_us > 0) ?
+        (uint32_t)(ok * 1000000ULL / sched_stats.last_round_us) : 0;
+    sched_stats.rounds++;
+    sched_stats.samples += ok;
+    sched_stats.errors += sched_sensor_count - ok;
+
+    return ok;
+}
+
+void aht10_sched_get_stats(struct aht10_sched_stats *stats)
+{
+    *stats = sched_stats;
+}
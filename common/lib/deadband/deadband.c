@@ -0,0 +1,43 @@
+// deadband.c - Report-on-change with deadband and heartbeat
+//
+// Readings are compared with the last *reported* value, not the previous
+// reading, so a slow drift still gets reported once it adds up to a band.
+
+#include <stdlib.h>
+#include <string.h>
+#include <app/lib/deadband.h>
+
+void deadband_init(struct deadband *db, int32_t temp_band, int32_t humid_band,
+                   uint32_t heartbeat_ms)
+{
+    memset(db, 0, sizeof(*db));
+    db->temp_band = temp_band;
+    db->humid_band = humid_band;
+    db->heartbeat_ms = heartbeat_ms;
+}
+
+bool deadband_check(struct deadband *db, int32_t temp, int32_t humid,
+                    int64_t now_ms)
+{
+    bool changed = !db->primed ||
+                   abs(temp - db->last_temp) >= db->temp_band ||
+                   abs(humid - db->last_humid) >= db->humid_band;
+    bool heartbeat = !changed && (now_ms - db->last_ms) >= db->heartbeat_ms;
+
+    if (!changed && !heartbeat) {
+        db->stats.suppressed++;
+        return false;
+    }
+
+    if (heartbeat) {
+        db->stats.heartbeats++;
+    }
+
+    db->primed = true;
+    db->last_temp = temp;
+    db->last_humid = humid;
+    db->last_ms = now_ms;
+    db->stats.sent++;
+
+    return true;
+}
@@ -0,0 +1,187 @@
+// i2c_scan.c - Fast I2C bus scanner with a presence bitmap
+//
+// Probes run back to back and only set bits in a bitmap; the table is
+// printed once afterwards, so neither sleeps nor console output end up
+// inside the timed section. The monitor reuses the bitmap to watch for
+// hot-plug changes without sweeping the whole address space every time.
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/printk.h>
+#include <app/lib/i2c_scan.h>
+
+static uint32_t i2c_scan_bitrate(const struct device *bus)
+{
+    uint32_t config;
+
+    if (i2c_get_config(bus, &config) != 0) {
+        return 0;
+    }
+
+    switch (I2C_SPEED_GET(config)) {
+    case I2C_SPEED_STANDARD:
+        return I2C_BITRATE_STANDARD;
+    case I2C_SPEED_FAST:
+        return I2C_BITRATE_FAST;
+    case I2C_SPEED_FAST_PLUS:
+        return I2C_BITRATE_FAST_PLUS;
+    case I2C_SPEED_HIGH:
+        return I2C_BITRATE_HIGH;
+    case I2C_SPEED_ULTRA:
+        return I2C_BITRATE_ULTRA;
+    default:
+        return 0;
+    }
+}
+
+bool i2c_scan_probe(const struct device *bus, uint8_t addr)
+{
+    uint8_t dummy;
+    struct i2c_msg msg = {
+        .buf = &dummy,
+        .len = 0,
+        .flags = I2C_MSG_WRITE | I2C_MSG_STOP,
+    };
+
+    return i2c_transfer(bus, &msg, 1, addr) == 0;
+}
+
+int i2c_scan_bus(const struct device *bus, struct i2c_scan_result *result)
+{
+    uint32_t start;
+
+    if (!device_is_ready(bus)) {
+        return -ENODEV;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->bitrate = i2c_scan_bitrate(bus);
+
+    start = k_cycle_get_32();
+
+    for (uint8_t addr = I2C_SCAN_ADDR_FIRST; addr <= I2C_SCAN_ADDR_LAST; addr++) {
+        if (i2c_scan_probe(bus, addr)) {
+            result->present[addr / 32] |= BIT(addr % 32);
+            result->count++;
+        }
+        result->probes++;
+
+        if (CONFIG_I2C_BUS_SCAN_PROBE_DELAY_US > 0) {
+            k_busy_wait(CONFIG_I2C_BUS_SCAN_PROBE_DELAY_US);
+        }
+    }
+
+    result->duration_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    return 0;
+}
+
+void i2c_scan_print(const struct i2c_scan_result *result)
+{
+    printk("     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n");
+
+    for (int row = 0; row < 128; row += 16) {
+        char line[3 * 16 + 1];
+        char *p = line;
+
+        for (int addr = row; addr < row + 16; addr++) {
+            if (addr < I2C_SCAN_ADDR_FIRST || addr > I2C_SCAN_ADDR_LAST) {
+                memcpy(p, "   ", 3);
+            } else if (i2c_scan_is_present(result, addr)) {
+                snprintk(p, 4, "%02x ", addr);
+            } else {
+                memcpy(p, "-- ", 3);
+            }
+            p += 3;
+        }
+        *p = '\0';
+
+        printk("%02x: %s\n", row, line);
+    }
+
+    printk("\nScan complete. Found %d device(s).\n", result->count);
+    printk("Scan time: %u us for %u addresses at %u Hz\n\n",
+           result->duration_us, result->probes, result->bitrate);
+}
+
+static void i2c_scan_set(struct i2c_scan_result *result, uint8_t addr, bool present)
+{
+    if (present) {
+        result->present[addr / 32] |= BIT(addr % 32);
+        result->count++;
+    } else {
+        result->present[addr / 32] &= ~BIT(addr % 32);
+        result->count--;
+    }
+}
+
+int i2c_scan_monitor_init(struct i2c_scan_monitor *mon, const struct device *bus,
+                          uint8_t slice)
+{
+    mon->bus = bus;
+    mon->slice = MAX(slice, 1);
+    mon->cursor = I2C_SCAN_ADDR_FIRST;
+    mon->probes = 0;
+    mon->duration_us = 0;
+
+    return i2c_scan_bus(bus, &mon->known);
+}
+
+int i2c_scan_monitor_poll(struct i2c_scan_monitor *mon, i2c_scan_event_cb_t cb,
+                          void *user_data)
+{
+    const uint8_t range = I2C_SCAN_ADDR_LAST - I2C_SCAN_ADDR_FIRST + 1;
+    uint8_t swept = 0;
+    int events = 0;
+    uint32_t start;
+
+    if (!device_is_ready(mon->bus)) {
+        return -ENODEV;
+    }
+
+    mon->probes = 0;
+    start = k_cycle_get_32();
+
+    // Known devices every cycle, so removals are noticed right away
+    for (uint8_t addr = I2C_SCAN_ADDR_FIRST; addr <= I2C_SCAN_ADDR_LAST; addr++) {
+        if (!i2c_scan_is_present(&mon->known, addr)) {
+            continue;
+        }
+
+        mon->probes++;
+        if (!i2c_scan_probe(mon->bus, addr)) {
+            i2c_scan_set(&mon->known, addr, false);
+            if (cb != NULL) {
+                cb(addr, false, user_data);
+            }
+            events++;
+        }
+    }
+
+    // Then the next slice of empty addresses, round robin
+    for (uint8_t i = 0; i < range && swept < mon->slice; i++) {
+        uint8_t addr = mon->cursor;
+
+        mon->cursor = (addr == I2C_SCAN_ADDR_LAST) ? I2C_SCAN_ADDR_FIRST : addr + 1;
+
+        if (i2c_scan_is_present(&mon->known, addr)) {
+            continue;
+        }
+
+        swept++;
+        mon->probes++;
+        if (i2c_scan_probe(mon->bus, addr)) {
+            i2c_scan_set(&mon->known, addr, true);
+            if (cb != NULL) {
+                cb(addr, true, user_data);
+            }
+            events++;
+        }
+    }
+
+    mon->duration_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    return events;
+}
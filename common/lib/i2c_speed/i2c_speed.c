@@ -0,0 +1,172 @@
+// i2c_speed.c - I2C bus speed negotiation with per-bus fallback
+//
+// Starting from the fastest speed asked for, the bus is reconfigured and
+// every device on it has to ACK its address and return the same bytes on
+// repeated reads. The first speed all of them pass at is kept; anything
+// else falls back one speed, down to standard mode.
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <app/lib/i2c_scan.h>
+#include <app/lib/i2c_speed.h>
+
+LOG_MODULE_REGISTER(i2c_speed, LOG_LEVEL_INF);
+
+uint32_t i2c_speed_to_bitrate(uint32_t speed)
+{
+    switch (speed) {
+    case I2C_SPEED_STANDARD:
+        return I2C_BITRATE_STANDARD;
+    case I2C_SPEED_FAST:
+        return I2C_BITRATE_FAST;
+    case I2C_SPEED_FAST_PLUS:
+        return I2C_BITRATE_FAST_PLUS;
+    case I2C_SPEED_HIGH:
+        return I2C_BITRATE_HIGH;
+    case I2C_SPEED_ULTRA:
+        return I2C_BITRATE_ULTRA;
+    default:
+        return 0;
+    }
+}
+
+static bool i2c_speed_all_ones(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != 0xFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int i2c_speed_check(const struct device *bus, const struct i2c_speed_target *target)
+{
+    uint8_t first[I2C_SPEED_CHECK_MAX_LEN];
+    uint8_t again[I2C_SPEED_CHECK_MAX_LEN];
+    size_t len = MIN(target->check_len, I2C_SPEED_CHECK_MAX_LEN);
+    int ret;
+
+    if (!i2c_scan_probe(bus, target->addr)) {
+        return -ENXIO;
+    }
+
+    if (len == 0) {
+        return 0;
+    }
+
+    ret = i2c_read(bus, first, len, target->addr);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (i2c_speed_all_ones(first, len)) {
+        return -EIO;
+    }
+
+    for (int i = 1; i < CONFIG_I2C_SPEED_CHECK_READS; i++) {
+        ret = i2c_read(bus, again, len, target->addr);
+        if (ret != 0) {
+            return ret;
+        }
+        if (memcmp(first, again, len) != 0) {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+int i2c_speed_negotiate(const struct device *bus, uint32_t max_speed,
+                        const struct i2c_speed_target *targets, size_t count,
+                        struct i2c_speed_result *result)
+{
+    int ret = 0;
+
+    if (!device_is_ready(bus)) {
+        return -ENODEV;
+    }
+
+    memset(result, 0, sizeof(*result));
+
+    for (uint32_t speed = MAX(max_speed, I2C_SPEED_STANDARD);
+         speed >= I2C_SPEED_STANDARD; speed--) {
+        // Controllers refuse speeds they can't generate
+        ret = i2c_configure(bus, I2C_SPEED_SET(speed) | I2C_MODE_CONTROLLER);
+        if (ret != 0) {
+            LOG_DBG("%s: %u Hz not supported (%d)", bus->name,
+                    i2c_speed_to_bitrate(speed), ret);
+            continue;
+        }
+
+        result->speed = speed;
+        result->bitrate = i2c_speed_to_bitrate(speed);
+        result->tried++;
+
+        for (size_t i = 0; i < count; i++) {
+            ret = i2c_speed_check(bus, &targets[i]);
+            if (ret != 0) {
+                LOG_WRN("%s: 0x%02x fails at %u Hz (%d), falling back", bus->name,
+                        targets[i].addr, result->bitrate, ret);
+                result->fallbacks++;
+                result->failed_addr = targets[i].addr;
+                result->err = ret;
+                break;
+            }
+        }
+
+        if (ret == 0) {
+            return 0;
+        }
+    }
+
+    // Nothing passed: stay at standard mode, the speed the bus most
+    // likely booted at
+    if (result->speed != I2C_SPEED_STANDARD) {
+        i2c_configure(bus, I2C_SPEED_SET(I2C_SPEED_STANDARD) | I2C_MODE_CONTROLLER);
+        result->speed = I2C_SPEED_STANDARD;
+        result->bitrate = I2C_BITRATE_STANDARD;
+    }
+
+    return ret != 0 ? ret : -ENOTSUP;
+}
+
+int i2c_speed_bench_run(const struct device *bus, uint16_t addr,
+                        struct i2c_msg *msgs, uint8_t num_msgs, uint32_t reps,
+                        struct i2c_speed_bench *result)
+{
+    uint32_t config;
+    uint32_t start, total_us;
+    int ret;
+
+    memset(result, 0, sizeof(*result));
+
+    if (reps == 0 || num_msgs == 0) {
+        return -EINVAL;
+    }
+
+    if (i2c_get_config(bus, &config) == 0) {
+        result->bitrate = i2c_speed_to_bitrate(I2C_SPEED_GET(config));
+    }
+
+    start = k_cycle_get_32();
+
+    for (uint32_t rep = 0; rep < reps; rep++) {
+        for (uint8_t i = 0; i < num_msgs; i++) {
+            ret = i2c_transfer(bus, &msgs[i], 1, addr);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+    }
+
+    total_us = MAX(k_cyc_to_us_floor32(k_cycle_get_32() - start), 1);
+    result->transfers_per_sec = (uint64_t)reps * num_msgs * USEC_PER_SEC / total_us;
+    result->sequence_us = total_us / reps;
+
+    return 0;
+}
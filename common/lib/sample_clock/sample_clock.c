@@ -0,0 +1,130 @@
+// sample_clock.c - Drift-free sampling schedule with jitter statistics
+//
+// A periodic k_timer reloads itself from its own expiry tick, not from
+// when the loop got round to waiting again, so the schedule is
+// anchor + n * period no matter how long each iteration takes. The
+// expiry function only counts and wakes the waiter; everything else,
+// including the statistics, runs in the waiting thread.
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <app/lib/sample_clock.h>
+
+static void sample_clock_expiry(struct k_timer *timer)
+{
+    struct sample_clock *clk = CONTAINER_OF(timer, struct sample_clock, timer);
+
+    // Called from the tick announcement, so this is the expiry's own tick
+    if (atomic_get(&clk->expiries) == 0) {
+        clk->anchor_ticks = k_uptime_ticks();
+    }
+    atomic_inc(&clk->expiries);
+    k_sem_give(&clk->tick);
+}
+
+static void sample_clock_restart(struct sample_clock *clk, uint32_t period_ms)
+{
+    k_timer_stop(&clk->timer);
+    k_sem_reset(&clk->tick);
+    atomic_set(&clk->expiries, 0);
+    clk->period_ticks = MAX(k_ms_to_ticks_ceil32(period_ms), 1);
+    clk->ticks = 0;
+
+    k_timer_start(&clk->timer, K_NO_WAIT, K_TICKS(clk->period_ticks));
+}
+
+void sample_clock_start(struct sample_clock *clk, uint32_t period_ms)
+{
+    k_timer_init(&clk->timer, sample_clock_expiry, NULL);
+    k_sem_init(&clk->tick, 0, 1);
+    atomic_set(&clk->new_period_ms, 0);
+    clk->missed = 0;
+    clk->samples = 0;
+    clk->lag_min_us = 0;
+    clk->lag_max_us = 0;
+    clk->lag_sum_us = 0;
+
+    sample_clock_restart(clk, period_ms);
+}
+
+void sample_clock_set_period(struct sample_clock *clk, uint32_t period_ms)
+{
+    atomic_set(&clk->new_period_ms, MAX(period_ms, 1));
+    k_sem_give(&clk->tick);
+}
+
+int sample_clock_wait(struct sample_clock *clk, k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    atomic_val_t period_ms;
+    uint32_t expiries;
+
+    while (true) {
+        if (k_sem_take(&clk->tick, sys_timepoint_timeout(end)) != 0) {
+            return -EAGAIN;
+        }
+
+        period_ms = atomic_clear(&clk->new_period_ms);
+        if (period_ms != 0) {
+            sample_clock_restart(clk, period_ms);
+            continue;
+        }
+
+        // The semaphore may be left over from an expiry the last call
+        // already counted; the expiry count is what counts
+        expiries = atomic_get(&clk->expiries);
+        if (expiries == clk->ticks) {
+            continue;
+        }
+
+        clk->missed += expiries - clk->ticks - 1;
+        clk->ticks = expiries;
+        return 0;
+    }
+}
+
+uint64_t sample_clock_tick_us(const struct sample_clock *clk)
+{
+    uint64_t tick = clk->anchor_ticks;
+
+    if (clk->ticks > 0) {
+        tick += (uint64_t)(clk->ticks - 1) * clk->period_ticks;
+    }
+
+    return k_ticks_to_us_floor64(tick);
+}
+
+void sample_clock_record(struct sample_clock *clk, uint64_t timestamp_us)
+{
+    uint64_t tick_us = sample_clock_tick_us(clk);
+    uint32_t lag_us = 0;
+
+    // Cycle counter and kernel ticks share a time base; anything before
+    // the tick is rounding, not an early sample
+    if (timestamp_us > tick_us) {
+        lag_us = (uint32_t)MIN(timestamp_us - tick_us, UINT32_MAX);
+    }
+
+    if (clk->samples == 0) {
+        clk->lag_min_us = lag_us;
+        clk->lag_max_us = lag_us;
+    } else {
+        clk->lag_min_us = MIN(clk->lag_min_us, lag_us);
+        clk->lag_max_us = MAX(clk->lag_max_us, lag_us);
+    }
+
+    clk->samples++;
+    clk->lag_sum_us += lag_us;
+}
+
+void sample_clock_get_stats(const struct sample_clock *clk,
+                            struct sample_clock_stats *stats)
+{
+    stats->ticks = clk->ticks;
+    stats->missed = clk->missed;
+    stats->samples = clk->samples;
+    stats->lag_min_us = clk->lag_min_us;
+    stats->lag_max_us = clk->lag_max_us;
+    stats->lag_mean_us = (clk->samples > 0) ? clk->lag_sum_us / clk->samples : 0;
+    stats->jitter_us = clk->lag_max_us - clk->lag_min_us;
+}
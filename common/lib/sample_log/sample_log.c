@@ -0,0 +1,469 @@
+// sample_log.c - Flash-backed store-and-forward sample log
+//
+// Samples are collected into chunks and each chunk is one entry in a flash
+// circular buffer (FCB). A chunk starts with the varint boot count, then
+// an absolute sample (varint timestamp in ms since that boot, raw
+// humidity, raw temperature); every following sample stores zigzag varints
+// of the timestamp delta-of-delta and the raw deltas. At a steady sampling
+// period in a steady room that is one byte per field. When the FCB is full
+// the oldest sector is rotated out; a partition that is one erase unit
+// loses its whole backlog at once.
+//
+// Every boot appends an entry holding only the new boot count, and so does
+// every drain after clearing the log, so the latest count is always the
+// last entry's and survives the next reset. The open chunk is written out
+// when it is full or CONFIG_SAMPLE_LOG_FLUSH_INTERVAL_MS after its first
+// sample, whichever comes first; that bounds what a reset loses.
+//
+// One mutex covers the RAM chunk and the FCB. A drain only holds it while
+// it reads the next chunk out of flash; decoding and the callback (which
+// typically waits for the UART) run without it, so appends carry on.
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/logging/log.h>
+#include <app/lib/sample_log.h>
+
+LOG_MODULE_REGISTER(sample_log, LOG_LEVEL_INF);
+
+#if FIXED_PARTITION_EXISTS(sample_log_partition)
+#define SAMPLE_LOG_AREA_ID  FIXED_PARTITION_ID(sample_log_partition)
+#else
+#define SAMPLE_LOG_AREA_ID  FIXED_PARTITION_ID(storage_partition)
+#endif
+
+#define SAMPLE_LOG_MAGIC    0x534c4f47  // "SLOG"
+#define SAMPLE_LOG_VERSION  2
+
+// Largest encoded sample: three 64-bit varints
+#define SAMPLE_LOG_RECORD_MAX   30
+
+// Largest entry header: one 32-bit varint
+#define SAMPLE_LOG_HEADER_MAX   5
+
+// Encoder/decoder state between consecutive samples of a chunk
+struct sample_log_state {
+    uint64_t ts_ms;
+    int64_t dt_ms;
+    uint32_t raw_humidity;
+    uint32_t raw_temperature;
+};
+
+static struct fcb log_fcb;
+static struct flash_sector log_sectors[CONFIG_SAMPLE_LOG_MAX_SECTORS];
+
+static uint8_t chunk[CONFIG_SAMPLE_LOG_CHUNK_SIZE];
+static size_t chunk_len;        // 0 while no chunk is open
+static size_t chunk_start;      // Header length, where the samples start
+static uint64_t chunk_key_ms;   // Timestamp of the open chunk's key sample
+static struct sample_log_state enc;
+
+static uint32_t boot_count;
+
+static struct sample_log_stats log_stats;
+
+static K_MUTEX_DEFINE(log_lock);
+
+static size_t put_varint(uint8_t *buf, uint64_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x80) {
+        buf[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    buf[n++] = (uint8_t)v;
+
+    return n;
+}
+
+static int get_varint(const uint8_t *buf, size_t len, size_t *pos, uint64_t *v)
+{
+    uint64_t result = 0;
+
+    for (int shift = 0; shift < 64 && *pos < len; shift += 7) {
+        uint8_t b = buf[(*pos)++];
+
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return 0;
+        }
+    }
+
+    return -EBADMSG;
+}
+
+static uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// Encode @p sample after @p state (or as a key sample if @p key) and
+// advance the state
+static size_t sample_log_encode(const struct telemetry_sample *sample, bool key,
+                                struct sample_log_state *state, uint8_t *out)
+{
+    uint64_t ts_ms = sample->timestamp_us / 1000;
+    size_t n = 0;
+
+    if (key) {
+        n += put_varint(&out[n], ts_ms);
+        n += put_varint(&out[n], sample->raw_humidity);
+        n += put_varint(&out[n], sample->raw_temperature);
+        state->dt_ms = 0;
+    } else {
+        int64_t dt_ms = (int64_t)(ts_ms - state->ts_ms);
+
+        n += put_varint(&out[n], zigzag(dt_ms - state->dt_ms));
+        n += put_varint(&out[n], zigzag((int64_t)sample->raw_humidity -
+                                        state->raw_humidity));
+        n += put_varint(&out[n], zigzag((int64_t)sample->raw_temperature -
+                                        state->raw_temperature));
+        state->dt_ms = dt_ms;
+    }
+
+    state->ts_ms = ts_ms;
+    state->raw_humidity = sample->raw_humidity;
+    state->raw_temperature = sample->raw_temperature;
+
+    return n;
+}
+
+static int sample_log_decode(const uint8_t *buf, size_t len,
+                             sample_log_drain_cb_t cb, void *user_data,
+                             int *count)
+{
+    struct sample_log_state state = {0};
+    struct telemetry_sample sample;
+    bool key = true;
+    uint64_t boot;
+    uint64_t f[3];
+    size_t pos = 0;
+    int ret;
+
+    ret = get_varint(buf, len, &pos, &boot);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // A boot entry has no samples
+    while (pos < len) {
+        for (int i = 0; i < 3; i++) {
+            ret = get_varint(buf, len, &pos, &f[i]);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+
+        if (key) {
+            // First sample of the chunk is absolute
+            state.ts_ms = f[0];
+            state.raw_humidity = (uint32_t)f[1];
+            state.raw_temperature = (uint32_t)f[2];
+            key = false;
+        } else {
+            state.dt_ms += unzigzag(f[0]);
+            state.ts_ms += state.dt_ms;
+            state.raw_humidity += (int32_t)unzigzag(f[1]);
+            state.raw_temperature += (int32_t)unzigzag(f[2]);
+        }
+
+        sample.timestamp_us = state.ts_ms * 1000;
+        sample.raw_humidity = state.raw_humidity & 0xFFFFF;
+        sample.raw_temperature = state.raw_temperature & 0xFFFFF;
+
+        ret = cb(&sample, (uint32_t)boot, user_data);
+        if (ret != 0) {
+            return ret;
+        }
+        (*count)++;
+    }
+
+    return 0;
+}
+
+static int sample_log_write(const uint8_t *data, size_t len)
+{
+    struct fcb_entry loc;
+    int ret;
+
+    ret = fcb_append(&log_fcb, len, &loc);
+    if (ret == -ENOSPC) {
+        // Full: drop the oldest sector and try again. On a single-sector
+        // partition that is the whole log. The boot count still survives,
+        // since the chunk appended next starts with it.
+        ret = fcb_rotate(&log_fcb);
+        if (ret != 0) {
+            return ret;
+        }
+        log_stats.rotations++;
+        ret = fcb_append(&log_fcb, len, &loc);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = flash_area_write(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), data, len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = fcb_append_finish(&log_fcb, &loc);
+    if (ret != 0) {
+        return ret;
+    }
+
+    log_stats.chunks++;
+    log_stats.bytes += len;
+    return 0;
+}
+
+// Append an entry holding only the current boot count
+static int sample_log_write_boot(void)
+{
+    uint8_t header[SAMPLE_LOG_HEADER_MAX];
+
+    return sample_log_write(header, put_varint(header, boot_count));
+}
+
+// Count this boot on from the last entry's boot count and record it
+static int sample_log_start_boot(void)
+{
+    uint8_t header[SAMPLE_LOG_HEADER_MAX];
+    struct fcb_entry loc;
+    uint64_t last = 0;
+    size_t pos = 0;
+    int ret;
+
+    ret = fcb_offset_last_n(&log_fcb, 1, &loc);
+    if (ret == 0) {
+        ret = flash_area_read(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), header,
+                              MIN(loc.fe_data_len, sizeof(header)));
+        if (ret != 0) {
+            return ret;
+        }
+        if (get_varint(header, MIN(loc.fe_data_len, sizeof(header)), &pos, &last) != 0) {
+            LOG_WRN("last entry has no boot count");
+        }
+    }
+
+    boot_count = (uint32_t)last + 1;
+    LOG_INF("boot %u", boot_count);
+
+    return sample_log_write_boot();
+}
+
+int sample_log_init(void)
+{
+    const struct flash_area *fa;
+    uint32_t count = ARRAY_SIZE(log_sectors);
+    int ret;
+
+    ret = flash_area_get_sectors(SAMPLE_LOG_AREA_ID, &count, log_sectors);
+    if (ret != 0) {
+        LOG_ERR("no sectors for the log partition (%d)", ret);
+        return ret;
+    }
+
+    log_fcb.f_magic = SAMPLE_LOG_MAGIC;
+    log_fcb.f_version = SAMPLE_LOG_VERSION;
+    log_fcb.f_sector_cnt = count;
+    log_fcb.f_scratch_cnt = 0;
+    log_fcb.f_sectors = log_sectors;
+
+    ret = fcb_init(SAMPLE_LOG_AREA_ID, &log_fcb);
+    if (ret == 0) {
+        LOG_INF("log mounted, %u sector(s)", count);
+        return sample_log_start_boot();
+    }
+
+    // Something else (or an older format) lives there: start over
+    LOG_WRN("no valid log (%d), erasing", ret);
+    ret = flash_area_open(SAMPLE_LOG_AREA_ID, &fa);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = flash_area_erase(fa, 0, fa->fa_size);
+    flash_area_close(fa);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = fcb_init(SAMPLE_LOG_AREA_ID, &log_fcb);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // The boot count starts over with the log
+    return sample_log_start_boot();
+}
+
+uint32_t sample_log_boot_count(void)
+{
+    return boot_count;
+}
+
+static int sample_log_flush_locked(void)
+{
+    int ret;
+
+    if (chunk_len == 0) {
+        return 0;
+    }
+
+    ret = sample_log_write(chunk, chunk_len);
+    if (ret != 0) {
+        LOG_ERR("chunk write failed (%d)", ret);
+        return ret;
+    }
+
+    chunk_len = 0;
+    return 0;
+}
+
+int sample_log_append(const struct telemetry_sample *sample)
+{
+    struct sample_log_state next;
+    uint8_t record[SAMPLE_LOG_RECORD_MAX];
+    uint32_t start = k_cycle_get_32();
+    size_t len;
+    int ret = 0;
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    if (chunk_len == 0) {
+        chunk_start = put_varint(chunk, boot_count);
+        chunk_len = chunk_start;
+    }
+    next = enc;
+    len = sample_log_encode(sample, chunk_len == chunk_start, &next, record);
+
+    // Doesn't fit: write the chunk out and start a new one with this
+    // sample as its key sample
+    if (chunk_len + len > sizeof(chunk)) {
+        ret = sample_log_flush_locked();
+        if (ret == 0) {
+            chunk_start = put_varint(chunk, boot_count);
+            chunk_len = chunk_start;
+            next = enc;
+            len = sample_log_encode(sample, true, &next, record);
+        }
+    }
+
+    if (ret == 0) {
+        if (chunk_len == chunk_start) {
+            chunk_key_ms = next.ts_ms;
+        }
+        memcpy(&chunk[chunk_len], record, len);
+        chunk_len += len;
+        enc = next;
+        log_stats.appended++;
+
+        // Bound what a reset can lose at slow sampling rates
+        if (CONFIG_SAMPLE_LOG_FLUSH_INTERVAL_MS > 0 &&
+            enc.ts_ms - chunk_key_ms >= CONFIG_SAMPLE_LOG_FLUSH_INTERVAL_MS) {
+            ret = sample_log_flush_locked();
+        }
+    }
+
+    log_stats.append_us += k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    k_mutex_unlock(&log_lock);
+    return ret;
+}
+
+int sample_log_flush(void)
+{
+    int ret;
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    ret = sample_log_flush_locked();
+    k_mutex_unlock(&log_lock);
+    return ret;
+}
+
+// Read the chunk after @p loc (the oldest one if @p loc is zeroed) into
+// @p buf. Returns its length, 0 at the end of the log, or a negative errno.
+static int sample_log_next_chunk(struct fcb_entry *loc, uint8_t *buf)
+{
+    int ret;
+
+    do {
+        ret = fcb_getnext(&log_fcb, loc);
+        if (ret == -ENOTSUP) {
+            return 0;
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        // Longer entries are not ours; skip them
+    } while (loc->fe_data_len > CONFIG_SAMPLE_LOG_CHUNK_SIZE);
+
+    ret = flash_area_read(log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(*loc), buf,
+                          loc->fe_data_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    return loc->fe_data_len;
+}
+
+int sample_log_drain(sample_log_drain_cb_t cb, void *user_data)
+{
+    uint8_t buf[CONFIG_SAMPLE_LOG_CHUNK_SIZE];
+    struct fcb_entry loc = {0};
+    uint32_t rotations;
+    int count = 0;
+    int len;
+    int ret;
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    ret = sample_log_flush_locked();
+    rotations = log_stats.rotations;
+
+    while (ret == 0) {
+        len = sample_log_next_chunk(&loc, buf);
+        if (len <= 0) {
+            ret = len;
+            break;
+        }
+
+        // Appends go on while the chunk is replayed
+        k_mutex_unlock(&log_lock);
+        ret = sample_log_decode(buf, len, cb, user_data, &count);
+        k_mutex_lock(&log_lock, K_FOREVER);
+
+        // A rotation meanwhile may have erased the sector being walked
+        if (ret == 0 && log_stats.rotations != rotations) {
+            ret = -ESTALE;
+        }
+    }
+
+    // Chunks written during the replay were replayed too; the lock keeps
+    // new ones out until the log is cleared. On failure everything is
+    // kept: the host sees duplicates next time, not gaps.
+    if (ret == 0) {
+        ret = fcb_clear(&log_fcb);
+    }
+    if (ret == 0) {
+        // Keep the boot count for the next boot
+        ret = sample_log_write_boot();
+    }
+    k_mutex_unlock(&log_lock);
+
+    return (ret == 0) ? count : ret;
+}
+
+void sample_log_get_stats(struct sample_log_stats *stats)
+{
+    k_mutex_lock(&log_lock, K_FOREVER);
+    *stats = log_stats;
+    stats->bytes += chunk_len;
+    k_mutex_unlock(&log_lock);
+}
@@ -0,0 +1,174 @@
+// serial_tx.c - Non-blocking UART output through an IRQ-drained ring buffer
+//
+// Writers copy their bytes into a ring buffer and enable the TX interrupt.
+// The ISR hands contiguous chunks of the ring straight to the UART FIFO
+// (no intermediate copy) and disables itself once the ring is empty.
+// Received bytes, if anyone asked for them, are passed to a callback.
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/logging/log.h>
+#include <app/lib/serial_tx.h>
+
+LOG_MODULE_REGISTER(serial_tx, LOG_LEVEL_INF);
+
+RING_BUF_DECLARE(tx_ring, CONFIG_SERIAL_TX_BUF_SIZE);
+
+static const struct device *tx_uart;
+static struct k_spinlock tx_lock;
+static K_SEM_DEFINE(tx_idle, 0, 1);
+static struct serial_tx_stats tx_stats;
+static serial_tx_rx_cb_t rx_cb;
+static void *rx_user_data;
+
+static void serial_tx_rx(const struct device *dev)
+{
+    uint8_t buf[16];
+    int len;
+
+    while ((len = uart_fifo_read(dev, buf, sizeof(buf))) > 0) {
+        for (int i = 0; i < len; i++) {
+            rx_cb(buf[i], rx_user_data);
+        }
+    }
+}
+
+static void serial_tx_isr(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (!uart_irq_update(dev)) {
+        return;
+    }
+
+    if (rx_cb != NULL && uart_irq_rx_ready(dev)) {
+        serial_tx_rx(dev);
+    }
+
+    if (!uart_irq_tx_ready(dev)) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    uint8_t *chunk;
+    uint32_t len = ring_buf_get_claim(&tx_ring, &chunk, CONFIG_SERIAL_TX_BUF_SIZE);
+    int sent = 0;
+
+    if (len == 0) {
+        uart_irq_tx_disable(dev);
+        k_sem_give(&tx_idle);
+    } else {
+        sent = uart_fifo_fill(dev, chunk, len);
+        sent = MAX(sent, 0);
+        tx_stats.bytes_sent += sent;
+    }
+
+    ring_buf_get_finish(&tx_ring, sent);
+    k_spin_unlock(&tx_lock, key);
+}
+
+int serial_tx_init(const struct device *uart)
+{
+    int ret;
+
+    if (!device_is_ready(uart)) {
+        return -ENODEV;
+    }
+
+    uart_irq_tx_disable(uart);
+
+    ret = uart_irq_callback_user_data_set(uart, serial_tx_isr, NULL);
+    if (ret != 0) {
+        LOG_ERR("%s: no interrupt-driven API (%d)", uart->name, ret);
+        return ret;
+    }
+
+    tx_uart = uart;
+    return 0;
+}
+
+int serial_tx_set_rx_callback(serial_tx_rx_cb_t cb, void *user_data)
+{
+    if (tx_uart == NULL) {
+        return -ENODEV;
+    }
+
+    uart_irq_rx_disable(tx_uart);
+    rx_cb = cb;
+    rx_user_data = user_data;
+    if (cb != NULL) {
+        uart_irq_rx_enable(tx_uart);
+    }
+
+    return 0;
+}
+
+int serial_tx_write(const void *data, size_t len)
+{
+    k_spinlock_key_t key;
+    uint32_t used;
+
+    if (tx_uart == NULL) {
+        return -ENODEV;
+    }
+
+    key = k_spin_lock(&tx_lock);
+
+    if (ring_buf_space_get(&tx_ring) < len) {
+        tx_stats.overflows++;
+        tx_stats.bytes_dropped += len;
+        k_spin_unlock(&tx_lock, key);
+        return -ENOSPC;
+    }
+
+    ring_buf_put(&tx_ring, data, len);
+    used = ring_buf_size_get(&tx_ring);
+    tx_stats.high_water = MAX(tx_stats.high_water, used);
+
+    k_spin_unlock(&tx_lock, key);
+
+    // The ISR turns itself off again once the ring is drained
+    uart_irq_tx_enable(tx_uart);
+
+    return len;
+}
+
+int serial_tx_puts(const char *str)
+{
+    return serial_tx_write(str, strlen(str));
+}
+
+size_t serial_tx_pending(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    size_t pending = ring_buf_size_get(&tx_ring);
+
+    k_spin_unlock(&tx_lock, key);
+    return pending;
+}
+
+int serial_tx_flush(k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+
+    // The semaphore may be left over from an earlier drain; the ring
+    // size is what counts
+    while (serial_tx_pending() > 0) {
+        if (k_sem_take(&tx_idle, sys_timepoint_timeout(end)) != 0) {
+            return -EAGAIN;
+        }
+    }
+
+    return 0;
+}
+
+void serial_tx_get_stats(struct serial_tx_stats *stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    *stats = tx_stats;
+    k_spin_unlock(&tx_lock, key);
+}
@@ -0,0 +1,77 @@
+// stream_filter.c - Moving average, median-of-N and exponential filters
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include <app/lib/stream_stats.h>
+
+void stream_filter_init(struct stream_filter *f, enum stream_filter_type type,
+                        uint8_t param)
+{
+    memset(f, 0, sizeof(*f));
+    f->type = type;
+
+    if (type == STREAM_FILTER_EMA) {
+        f->taps = MIN(param, 15);
+    } else {
+        f->taps = CLAMP(param, 1, STREAM_FILTER_MAX_TAPS);
+    }
+}
+
+static int32_t stream_filter_median(const struct stream_filter *f)
+{
+    int32_t sorted[STREAM_FILTER_MAX_TAPS];
+    uint8_t n = f->count;
+
+    // Insertion sort: at most 16 entries
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t v = f->hist[i];
+        uint8_t j = i;
+
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    if (n & 1) {
+        return sorted[n / 2];
+    }
+
+    return (int32_t)(((int64_t)sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+}
+
+int32_t stream_filter_update(struct stream_filter *f, int32_t x)
+{
+    switch (f->type) {
+    case STREAM_FILTER_MOVING_AVG:
+    case STREAM_FILTER_MEDIAN:
+        // Ring of the last taps inputs; the sum follows it incrementally
+        if (f->count == f->taps) {
+            f->acc -= f->hist[f->head];
+        } else {
+            f->count++;
+        }
+        f->hist[f->head] = x;
+        f->acc += x;
+        f->head = (f->head + 1) % f->taps;
+
+        if (f->type == STREAM_FILTER_MEDIAN) {
+            return stream_filter_median(f);
+        }
+        return (int32_t)(f->acc / f->count);
+
+    case STREAM_FILTER_EMA:
+        // acc holds y * 2^shift; the first input seeds it
+        if (f->count == 0) {
+            f->acc = (int64_t)x << f->taps;
+            f->count = 1;
+        } else {
+            f->acc += x - (f->acc >> f->taps);
+        }
+        return (int32_t)((f->acc + ((1LL << f->taps) >> 1)) >> f->taps);
+
+    default:
+        return x;
+    }
+}
@@ -0,0 +1,78 @@
+// stream_stats.c - Welford running mean/variance plus min/max
+//
+// Mean and M2 are Q16 fixed point. With inputs in hundredths (|x| below
+// 2^15) a 65535-sample window stays well inside 64 bits.
+
+#include <zephyr/sys/util.h>
+#include <app/lib/stream_stats.h>
+
+void stream_stats_reset(struct stream_stats *s)
+{
+    s->count = 0;
+    s->mean_q16 = 0;
+    s->m2_q16 = 0;
+    s->min = INT32_MAX;
+    s->max = INT32_MIN;
+}
+
+void stream_stats_add(struct stream_stats *s, int32_t x)
+{
+    int64_t x_q16 = (int64_t)x << 16;
+    int64_t delta = x_q16 - s->mean_q16;
+
+    s->count++;
+    s->mean_q16 += delta / (int64_t)s->count;
+
+    // delta * (x - new mean) is Q32; drop 8 bits from each side first
+    s->m2_q16 += (delta >> 8) * ((x_q16 - s->mean_q16) >> 8);
+
+    s->min = MIN(s->min, x);
+    s->max = MAX(s->max, x);
+}
+
+int32_t stream_stats_mean(const struct stream_stats *s)
+{
+    return (int32_t)((s->mean_q16 + (1 << 15)) >> 16);
+}
+
+static uint32_t stream_stats_isqrt(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)res;
+}
+
+static uint64_t stream_stats_variance_q16(const struct stream_stats *s)
+{
+    if (s->count < 2 || s->m2_q16 <= 0) {
+        return 0;
+    }
+
+    return (uint64_t)s->m2_q16 / (s->count - 1);
+}
+
+uint32_t stream_stats_variance(const struct stream_stats *s)
+{
+    return (uint32_t)((stream_stats_variance_q16(s) + (1 << 15)) >> 16);
+}
+
+uint32_t stream_stats_stddev(const struct stream_stats *s)
+{
+    // sqrt of a Q16 value is Q8
+    return (stream_stats_isqrt(stream_stats_variance_q16(s)) + (1 << 7)) >> 8;
+}
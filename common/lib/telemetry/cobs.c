@@ -0,0 +1,31 @@
+// cobs.c - Consistent Overhead Byte Stuffing encoder
+
+#include <app/lib/cobs.h>
+
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t code_idx = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    // Each block starts with a code byte: the distance to the next zero
+    // (or 0xFF for a full 254-byte run without one)
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+            continue;
+        }
+
+        dst[out++] = src[i];
+        if (++code == 0xFF) {
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+        }
+    }
+
+    dst[code_idx] = code;
+    return out;
+}
@@ -0,0 +1,84 @@
+// telemetry.c - Compact binary sample frames
+
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys/crc.h>
+#include <app/lib/telemetry.h>
+
+// Timestamp and raw readings, 13 bytes
+static void telemetry_put_sample(const struct telemetry_sample *sample, uint8_t *buf)
+{
+    uint64_t packed;
+
+    // Two 20-bit readings share 5 bytes
+    packed = ((uint64_t)(sample->raw_humidity & 0xFFFFF) << 20) |
+             (sample->raw_temperature & 0xFFFFF);
+
+    sys_put_le64(sample->timestamp_us, &buf[0]);
+    sys_put_le40(packed, &buf[8]);
+}
+
+size_t telemetry_encode_sample(const struct telemetry_sample *sample,
+                               uint16_t seq, uint8_t *out)
+{
+    uint8_t payload[TELEMETRY_PAYLOAD_LEN];
+    size_t len;
+
+    payload[0] = TELEMETRY_TYPE_SAMPLE;
+    sys_put_le16(seq, &payload[1]);
+    telemetry_put_sample(sample, &payload[3]);
+    sys_put_le16(crc16_itu_t(0xFFFF, payload, 16), &payload[16]);
+
+    len = cobs_encode(payload, sizeof(payload), out);
+    out[len++] = 0x00;
+
+    return len;
+}
+
+size_t telemetry_encode_log_sample(const struct telemetry_sample *sample,
+                                   uint32_t boot, uint16_t seq, uint8_t *out)
+{
+    uint8_t payload[TELEMETRY_LOG_PAYLOAD_LEN];
+    size_t len;
+
+    payload[0] = TELEMETRY_TYPE_LOG_SAMPLE;
+    sys_put_le16(seq, &payload[1]);
+    sys_put_le16((uint16_t)boot, &payload[3]);
+    telemetry_put_sample(sample, &payload[5]);
+    sys_put_le16(crc16_itu_t(0xFFFF, payload, 18), &payload[18]);
+
+    len = cobs_encode(payload, sizeof(payload), out);
+    out[len++] = 0x00;
+
+    return len;
+}
+
+static void telemetry_put_channel(const struct telemetry_channel_stats *ch,
+                                  uint8_t *buf)
+{
+    sys_put_le16((uint16_t)CLAMP(ch->value, INT16_MIN, INT16_MAX), &buf[0]);
+    sys_put_le16((uint16_t)CLAMP(ch->mean, INT16_MIN, INT16_MAX), &buf[2]);
+    sys_put_le16((uint16_t)CLAMP(ch->min, INT16_MIN, INT16_MAX), &buf[4]);
+    sys_put_le16((uint16_t)CLAMP(ch->max, INT16_MIN, INT16_MAX), &buf[6]);
+    sys_put_le16((uint16_t)MIN(ch->stddev, UINT16_MAX), &buf[8]);
+}
+
+size_t telemetry_encode_aggregate(const struct telemetry_aggregate *agg,
+                                  uint16_t seq, uint8_t *out)
+{
+    uint8_t payload[TELEMETRY_AGGREGATE_LEN];
+    size_t len;
+
+    payload[0] = TELEMETRY_TYPE_AGGREGATE;
+    sys_put_le16(seq, &payload[1]);
+    sys_put_le64(agg->timestamp_us, &payload[3]);
+    sys_put_le16(agg->count, &payload[11]);
+    telemetry_put_channel(&agg->temperature, &payload[13]);
+    telemetry_put_channel(&agg->humidity, &payload[23]);
+    sys_put_le16(crc16_itu_t(0xFFFF, payload, 33), &payload[33]);
+
+    len = cobs_encode(payload, sizeof(payload), out);
+    out[len++] = 0x00;
+
+    return len;
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Compare BENCH results between two twister runs.
+
+Reads the "recording" entries that twister stores for every test whose
+console harness records "BENCH <metric> <value>" lines, and prints each
+metric side by side. Exits with status 1 if any metric got worse by more
+than the threshold, so it can gate CI.
+
+    bench_compare.py baseline/twister.json twister-out/twister.json
+    bench_compare.py --threshold 5 old.json new.json
+    bench_compare.py twister-out/twister.json          # just list
+
+Metrics are "lower is better" unless their name ends in a rate
+("_per_sec"), in which case a drop is the regression.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Return {(test, metric): value} from a twister.json file."""
+    with open(path) as f:
+        report = json.load(f)
+
+    results = {}
+    for suite in report.get("testsuites", []):
+        for rec in suite.get("recording") or []:
+            try:
+                results[(suite["name"], rec["metric"])] = int(rec["value"])
+            except (KeyError, ValueError):
+                continue
+    return results
+
+
+def higher_is_better(metric):
+    return metric.endswith("_per_sec")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline", help="twister.json of the reference run")
+    parser.add_argument("current", nargs="?", help="twister.json to check")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed regression in percent (default 10)")
+    args = parser.parse_args()
+
+    base = load(args.baseline)
+    if not args.current:
+        for (test, metric), value in sorted(base.items()):
+            print("%-45s %-32s %10d" % (test, metric, value))
+        return 0
+
+    cur = load(args.current)
+    regressions = 0
+    for key in sorted(set(base) | set(cur)):
+        test, metric = key
+        old, new = base.get(key), cur.get(key)
+        if old is None or new is None:
+            print("%-45s %-32s %10s -> %10s" % (test, metric, old, new))
+            continue
+
+        change = (new - old) * 100.0 / old if old else 0.0
+        worse = -change if higher_is_better(metric) else change
+        flag = ""
+        if worse > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-45s %-32s %10d -> %10d %+7.1f%%%s" % (
+            test, metric, old, new, change, flag))
+
+    if regressions:
+        print("%d regression(s) over %.1f%%" % (regressions, args.threshold),
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""Decode COBS-framed binary telemetry from the AHT10 examples.
+
+Reads a serial port (needs pyserial) or a capture file / stdin, checks each
+frame's CRC, reports dropped frames from sequence gaps and prints one line
+per sample or oversampling aggregate. Samples replayed from the flash log
+have their own frame type and sequence, carry the boot they were taken in
+and are marked "log". Frame layout is documented in
+include/app/lib/telemetry.h.
+
+    telemetry_decode.py /dev/ttyUSB0
+    telemetry_decode.py --baud 115200 --json /dev/ttyUSB0
+    telemetry_decode.py --file capture.bin
+"""
+
+import argparse
+import binascii
+import json
+import struct
+import sys
+
+TYPE_SAMPLE = 0x01
+TYPE_AGGREGATE = 0x02
+TYPE_LOG_SAMPLE = 0x03
+PAYLOAD_LEN = 18
+LOG_PAYLOAD_LEN = 20
+AGGREGATE_LEN = 35
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def check_crc(payload):
+    crc = struct.unpack_from("<H", payload, len(payload) - 2)[0]
+    if binascii.crc_hqx(payload[:-2], 0xFFFF) != crc:
+        raise ValueError("CRC mismatch")
+
+
+def parse_frame(payload):
+    if not payload:
+        raise ValueError("empty frame")
+    if payload[0] == TYPE_SAMPLE:
+        return parse_sample(payload)
+    if payload[0] == TYPE_LOG_SAMPLE:
+        return parse_log_sample(payload)
+    if payload[0] == TYPE_AGGREGATE:
+        return parse_aggregate(payload)
+    raise ValueError("unknown frame type 0x%02x" % payload[0])
+
+
+def parse_channel(payload, offset):
+    value, mean, lo, hi, stddev = struct.unpack_from("<hhhhH", payload, offset)
+    return {
+        "value": value / 100.0,
+        "mean": mean / 100.0,
+        "min": lo / 100.0,
+        "max": hi / 100.0,
+        "stddev": stddev / 100.0,
+    }
+
+
+def parse_aggregate(payload):
+    if len(payload) != AGGREGATE_LEN:
+        raise ValueError("bad length %d" % len(payload))
+    check_crc(payload)
+
+    seq, timestamp_us, count = struct.unpack_from("<HQH", payload, 1)
+    return {
+        "seq": seq,
+        "timestamp_us": timestamp_us,
+        "count": count,
+        "temperature": parse_channel(payload, 13),
+        "humidity": parse_channel(payload, 23),
+    }
+
+
+def unpack_readings(payload, offset):
+    timestamp_us = struct.unpack_from("<Q", payload, offset)[0]
+    packed = int.from_bytes(payload[offset + 8:offset + 13], "little")
+    raw_humidity = packed >> 20
+    raw_temperature = packed & 0xFFFFF
+
+    return {
+        "timestamp_us": timestamp_us,
+        "raw_humidity": raw_humidity,
+        "raw_temperature": raw_temperature,
+        "humidity": raw_humidity * 100.0 / (1 << 20),
+        "temperature": raw_temperature * 200.0 / (1 << 20) - 50.0,
+    }
+
+
+def parse_sample(payload):
+    if len(payload) != PAYLOAD_LEN:
+        raise ValueError("bad length %d" % len(payload))
+    check_crc(payload)
+
+    sample = {"seq": struct.unpack_from("<H", payload, 1)[0]}
+    sample.update(unpack_readings(payload, 3))
+    return sample
+
+
+def parse_log_sample(payload):
+    if len(payload) != LOG_PAYLOAD_LEN:
+        raise ValueError("bad length %d" % len(payload))
+    check_crc(payload)
+
+    seq, boot = struct.unpack_from("<HH", payload, 1)
+    sample = {"seq": seq, "log": True, "boot": boot}
+    sample.update(unpack_readings(payload, 5))
+    return sample
+
+
+class Decoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.last_seq = {}
+        self.frames = 0
+        self.corrupt = 0
+        self.dropped = 0
+
+    def feed(self, data):
+        """Yield decoded samples for every complete frame in @data."""
+        self.buf += data
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                return
+            chunk = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if not chunk:
+                continue
+            try:
+                sample = parse_frame(cobs_decode(chunk))
+            except ValueError:
+                self.corrupt += 1
+                continue
+
+            # Live and replayed frames count separately
+            stream = "log" in sample
+            if stream in self.last_seq:
+                self.dropped += (sample["seq"] - self.last_seq[stream] - 1) & 0xFFFF
+            self.last_seq[stream] = sample["seq"]
+            self.frames += 1
+            yield sample
+
+
+def open_input(args):
+    if args.file == "-":
+        return sys.stdin.buffer
+    if args.file:
+        return open(args.file, "rb")
+    import serial  # pyserial
+
+    return serial.Serial(args.port, args.baud, timeout=1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", nargs="?", help="serial port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--file", help="read a capture file ('-' for stdin)")
+    parser.add_argument("--json", action="store_true", help="one JSON object per sample")
+    args = parser.parse_args()
+
+    if not args.port and not args.file:
+        parser.error("need a serial port or --file")
+
+    decoder = Decoder()
+    stream = open_input(args)
+    try:
+        while True:
+            data = stream.read(256)
+            if not data:
+                if args.file:
+                    break
+                continue
+            for sample in decoder.feed(data):
+                if args.json:
+                    print(json.dumps(sample), flush=True)
+                elif "count" in sample:
+                    t, h = sample["temperature"], sample["humidity"]
+                    print("#%-5d %12.6fs  %7.2f C (mean %.2f, sd %.2f, %.2f..%.2f)"
+                          "  %6.2f %%RH (mean %.2f, sd %.2f, %.2f..%.2f)  n=%d" % (
+                              sample["seq"], sample["timestamp_us"] / 1e6,
+                              t["value"], t["mean"], t["stddev"], t["min"], t["max"],
+                              h["value"], h["mean"], h["stddev"], h["min"], h["max"],
+                              sample["count"]), flush=True)
+                elif "log" in sample:
+                    print("L%-5d boot %-5d %12.6fs  %7.2f C  %6.2f %%RH" % (
+                        sample["seq"], sample["boot"], sample["timestamp_us"] / 1e6,
+                        sample["temperature"], sample["humidity"]), flush=True)
+                else:
+                    print("#%-5d %12.6fs  %7.2f C  %6.2f %%RH" % (
+                        sample["seq"], sample["timestamp_us"] / 1e6,
+                        sample["temperature"], sample["humidity"]), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+    print("frames: %d, corrupt: %d, dropped: %d" % (
+        decoder.frames, decoder.corrupt, decoder.dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
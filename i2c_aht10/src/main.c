@@ -5,186 +5,346 @@
 #include <zephyr/drivers/uart.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/task_wdt/task_wdt.h>
+#include <app/lib/i2c_scan.h>
+#include <app/lib/i2c_speed.h>
+#include <app/drivers/sensor/aht10.h>
+#include <app/lib/aht10_sched.h>
+#include <app/lib/fixedpoint.h>
+#include <app/lib/deadband.h>
+#include <app/lib/bench.h>
+#include <app/lib/sample_clock.h>
 
-LOG_MODULE_REGISTER(aht10_reader, LOG_LEVEL_INF);
+LOG_MODULE_REGISTER(aht10_reader, CONFIG_APP_LOG_LEVEL);
 
-// AHT10 I2C address
-#define AHT10_I2C_ADDR 0x38
+// AHT10 sensor node from the devicetree overlay
+#define AHT10_NODE DT_NODELABEL(aht10)
 
-// AHT10 Commands
-#define AHT10_CMD_INIT          0xE1
-#define AHT10_CMD_TRIGGER       0xAC
-#define AHT10_CMD_SOFT_RESET    0xBA
-#define AHT10_STATUS_BUSY       0x80
-#define AHT10_STATUS_CALIBRATED 0x08
+// Print report-on-change statistics every this many rounds
+#define REPORT_STATS_INTERVAL   10
 
-// I2C device pointer
+// Sample sequences timed per bus speed in the benchmark
+#define BUS_BENCH_REPS          50
+
+// All enabled AHT10 instances, in devicetree order, on whatever bus they sit
+static const struct aht10_sched_sensor sensors[] = {
+    AHT10_SCHED_SENSORS_DT
+};
+
+static struct aht10_sched_result results[ARRAY_SIZE(sensors)];
+
+#ifdef CONFIG_DEADBAND_REPORT
+// One report-on-change gate per sensor
+static struct deadband gates[ARRAY_SIZE(sensors)];
+#endif
+
+// I2C bus the first sensor sits on (used for the bus scan)
 static const struct device *i2c_dev;
 
-// Function to initialize AHT10 sensor
-int aht10_init(void)
+// Round schedule: a tick every CONFIG_APP_SAMPLE_PERIOD_MS, drift-free
+static struct sample_clock round_clock;
+
+// Function to log one sensor's reading (in hundredths) from a round.
+// Deferred logging only copies the arguments here; formatting and console
+// output happen later in the log thread (or on the host, with dictionary
+// logging), so no string is built in the sampling loop.
+void print_reading(const struct device *dev, const struct aht10_sample *raw)
 {
-    uint8_t init_cmd[3] = {AHT10_CMD_INIT, 0x08, 0x00};
-    uint8_t status;
-    int ret;
+    struct aht10_bus_stats bus;
+    int32_t temperature, humidity;
     
-    printk("Initializing AHT10 sensor...\n");
-    
-    // Send soft reset command first
-    uint8_t reset_cmd = AHT10_CMD_SOFT_RESET;
-    ret = i2c_write(i2c_dev, &reset_cmd, 1, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to send reset command to AHT10\n");
-        return ret;
+    // Debug: raw values and the I2C traffic this sample cost
+    // (payload bytes + 1 address byte per transfer)
+    if (IS_ENABLED(CONFIG_APP_LOG_LEVEL_DBG)) {
+        aht10_get_bus_stats(dev, &bus, NULL);
+        LOG_DBG("%s: Raw humidity: %u, Raw temperature: %u, at %llu us", dev->name,
+                raw->raw_humidity, raw->raw_temperature, raw->timestamp_us);
+        LOG_DBG("%s: Bus: %u transfer(s), %u byte(s)", dev->name,
+                bus.transactions, bus.bytes + bus.transactions);
     }
     
-    // Wait for reset to complete
-    k_msleep(20);
+    // Convert with integer shifts and multiplies, no floating point
+    temperature = aht10_raw_to_centi_celsius(raw->raw_temperature);
+    humidity = aht10_raw_to_centi_percent(raw->raw_humidity);
     
-    // Send initialization command
-    ret = i2c_write(i2c_dev, init_cmd, 3, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to initialize AHT10\n");
-        return ret;
+    // Values are in hundredths, logged with 2 decimal places
+    LOG_INF("%s: Temperature: " FIXEDPOINT_CENTI_FMT "°C, Humidity: " FIXEDPOINT_CENTI_FMT "%%",
+            dev->name, FIXEDPOINT_CENTI_ARGS(temperature), FIXEDPOINT_CENTI_ARGS(humidity));
+}
+
+// Function to decide whether a reading is worth printing
+bool should_report(size_t index, const struct aht10_sample *raw)
+{
+#ifdef CONFIG_DEADBAND_REPORT
+    return deadband_check(&gates[index],
+                          aht10_raw_to_centi_celsius(raw->raw_temperature),
+                          aht10_raw_to_centi_percent(raw->raw_humidity),
+                          raw->timestamp_us / USEC_PER_MSEC);
+#else
+    ARG_UNUSED(index);
+    ARG_UNUSED(raw);
+    return true;
+#endif
+}
+
+// Function to print how many readings report-on-change held back
+void print_report_stats(void)
+{
+#ifdef CONFIG_DEADBAND_REPORT
+    struct deadband_stats total = {0};
+    
+    for (size_t i = 0; i < ARRAY_SIZE(gates); i++) {
+        total.sent += gates[i].stats.sent;
+        total.suppressed += gates[i].stats.suppressed;
+        total.heartbeats += gates[i].stats.heartbeats;
     }
     
-    // Wait for initialization
-    k_msleep(10);
+    printk("Reports: %u sent, %u suppressed (%u heartbeat(s))\n",
+           total.sent, total.suppressed, total.heartbeats);
+#endif
+}
+
+// Function to print the sensors' fault and recovery counters, and the
+// worst round time seen: the bound on sample latency, faults included
+void print_fault_stats(void)
+{
+    struct aht10_fault_stats total = {0}, faults;
+    struct aht10_sched_stats stats;
     
-    // Check if sensor is calibrated
-    ret = i2c_read(i2c_dev, &status, 1, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to read AHT10 status\n");
-        return ret;
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        aht10_get_fault_stats(sensors[i].dev, &faults);
+        total.timeouts += faults.timeouts;
+        total.bus_errors += faults.bus_errors;
+        total.bus_recoveries += faults.bus_recoveries;
+        total.reinits += faults.reinits;
+        total.reinit_failures += faults.reinit_failures;
+        total.crc_errors += faults.crc_errors;
     }
     
-    if (!(status & AHT10_STATUS_CALIBRATED)) {
-        printk("ERROR: AHT10 not calibrated (status: 0x%02X)\n", status);
-        return -1;
+    aht10_sched_get_stats(&stats);
+    printk("Faults: %u timeout(s), %u bus error(s), %u bus recovery(ies), "
+           "%u re-init(s) (%u failed), worst round %u us, %u CRC error(s)\n",
+           total.timeouts, total.bus_errors, total.bus_recoveries,
+           total.reinits, total.reinit_failures, stats.max_round_us,
+           total.crc_errors);
+}
+
+// Function to print how closely samples keep to the round schedule:
+// lag is from a round's tick to each sample's conversion completing
+void print_schedule_stats(void)
+{
+    struct sample_clock_stats stats;
+    
+    sample_clock_get_stats(&round_clock, &stats);
+    printk("Schedule: %u tick(s), %u missed, lag min %u / mean %u / max %u us, "
+           "jitter %u us\n", stats.ticks, stats.missed, stats.lag_min_us,
+           stats.lag_mean_us, stats.lag_max_us, stats.jitter_us);
+}
+
+// Function to scan I2C bus
+void scan_i2c_bus(void)
+{
+    struct i2c_scan_result result;
+    
+    printk("Starting I2C bus scan...\n");
+    printk("Scanning addresses 0x08 to 0x77\n");
+    
+    // Back-to-back zero-length probes into a bitmap; the table is printed
+    // once at the end so console output doesn't slow the scan down
+    if (i2c_scan_bus(i2c_dev, &result) != 0) {
+        printk("ERROR: I2C bus scan failed\n");
+        return;
     }
     
-    printk("AHT10 initialized successfully (status: 0x%02X)\n", status);
-    return 0;
+    i2c_scan_print(&result);
 }
 
-// Function to read temperature and humidity from AHT10
-int aht10_read_data(float *temperature, float *humidity)
+#ifdef CONFIG_I2C_SPEED
+// Function to fill the speed-check targets for all sensors on @p bus
+size_t bus_targets(const struct device *bus, struct i2c_speed_target *targets)
 {
-    uint8_t trigger_cmd[3] = {AHT10_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t data[6];
-    uint32_t raw_humidity, raw_temperature;
-    int ret;
+    size_t count = 0;
     
-    // Send measurement trigger command
-    ret = i2c_write(i2c_dev, trigger_cmd, 3, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to trigger AHT10 measurement\n");
-        return ret;
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        if (sensors[i].bus == bus) {
+            targets[count].addr = sensors[i].addr;
+            targets[count].check_len = AHT10_DATA_LEN;
+            count++;
+        }
     }
     
-    // Wait for measurement to complete (typical 75ms)
-    k_msleep(80);
+    return count;
+}
+
+// Function to run each sensor bus at the fastest speed every sensor on it
+// still reads back cleanly at; a bus that fails falls back on its own
+void negotiate_bus_speeds(void)
+{
+    struct i2c_speed_target targets[ARRAY_SIZE(sensors)];
+    struct i2c_speed_result result;
+    size_t count;
+    int ret;
     
-    // Check if measurement is ready
-    do {
-        ret = i2c_read(i2c_dev, data, 1, AHT10_I2C_ADDR);
-        if (ret != 0) {
-            printk("ERROR: Failed to read AHT10 status\n");
-            return ret;
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        const struct device *bus = sensors[i].bus;
+        bool seen = false;
+        
+        for (size_t j = 0; j < i; j++) {
+            seen |= (sensors[j].bus == bus);
+        }
+        if (seen) {
+            continue;
         }
         
-        if (data[0] & AHT10_STATUS_BUSY) {
-            k_msleep(10);  // Wait a bit more if still busy
+        count = bus_targets(bus, targets);
+        ret = i2c_speed_negotiate(bus, CONFIG_APP_I2C_MAX_SPEED, targets, count, &result);
+        if (ret != 0) {
+            printk("WARNING: %s fails even at %u Hz (error: %d)\n",
+                   bus->name, result.bitrate, ret);
+            continue;
         }
-    } while (data[0] & AHT10_STATUS_BUSY);
+        
+        printk("I2C: %s at %u Hz (%u speed(s) tried, %u fallback(s))\n",
+               bus->name, result.bitrate, result.tried, result.fallbacks);
+    }
+}
+#endif
+
+#ifdef CONFIG_APP_BENCHMARK
+// Function to sum the bus bytes (address byte included) of all sensors
+uint64_t total_bus_bytes(void)
+{
+    struct aht10_bus_stats total;
+    uint64_t bytes = 0;
     
-    // Read the full 6-byte data
-    ret = i2c_read(i2c_dev, data, 6, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to read AHT10 data\n");
-        return ret;
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        aht10_get_bus_stats(sensors[i].dev, NULL, &total);
+        bytes += total.bytes + total.transactions;
     }
     
-    // Debug: Print raw data bytes
-    printk("Raw data: %02X %02X %02X %02X %02X %02X\n", 
-           data[0], data[1], data[2], data[3], data[4], data[5]);
+    return bytes;
+}
+
+// Function to time rounds back to back, without console output, and
+// report the results in machine-readable form
+void benchmark_rounds(uint32_t ready_us)
+{
+    uint32_t min_us = UINT32_MAX, max_us = 0, samples = 0;
+    uint64_t total_us = 0;
+    uint64_t bus_bytes = total_bus_bytes();
+    uint32_t start, round_us, report_us, log_bytes;
+    int ret;
     
-    // Extract raw humidity (20-bit, bits 19:0 of data[1:3])
-    raw_humidity = ((uint32_t)data[1] << 12) | 
-                   ((uint32_t)data[2] << 4) | 
-                   ((uint32_t)data[3] >> 4);
+    printk("Benchmark: %d rounds back to back\n", CONFIG_APP_BENCHMARK_ROUNDS);
     
-    // Extract raw temperature (20-bit, bits 19:0 of data[3:5])
-    raw_temperature = (((uint32_t)data[3] & 0x0F) << 16) | 
-                      ((uint32_t)data[4] << 8) | 
-                      (uint32_t)data[5];
+    for (int round = 0; round < CONFIG_APP_BENCHMARK_ROUNDS; round++) {
+        start = k_cycle_get_32();
+        ret = aht10_sched_run(results, K_MSEC(500));
+        round_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+        
+        samples += MAX(ret, 0);
+        min_us = MIN(min_us, round_us);
+        max_us = MAX(max_us, round_us);
+        total_us += round_us;
+    }
     
-    // Debug: Print raw values
-    printk("Raw humidity: %u, Raw temperature: %u\n", raw_humidity, raw_temperature);
+    bus_bytes = total_bus_bytes() - bus_bytes;
     
-    // Convert to actual values
-    *humidity = ((float)raw_humidity / 1048576.0f) * 100.0f;
-    *temperature = (((float)raw_temperature / 1048576.0f) * 200.0f) - 50.0f;
+    // Cost of reporting the last round, in the sampling thread: the log
+    // thread runs at a lower priority, so nothing is drained in between
+    log_bytes = bench_log_pending();
+    start = k_cycle_get_32();
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        print_reading(sensors[i].dev, &results[i].sample);
+    }
+    report_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    log_bytes = bench_log_pending() - log_bytes;
     
-    return 0;
+    bench_report("aht10.init_us", ready_us);
+    bench_report("aht10.round_min_us", min_us);
+    bench_report("aht10.round_avg_us", total_us / CONFIG_APP_BENCHMARK_ROUNDS);
+    bench_report("aht10.round_max_us", max_us);
+    bench_report("aht10.samples_per_sec",
+                 total_us > 0 ? (uint64_t)samples * USEC_PER_SEC / total_us : 0);
+    bench_report("aht10.bus_bytes_per_sample", samples > 0 ? bus_bytes / samples : 0);
+    bench_report("aht10.report_us_per_sample", report_us / ARRAY_SIZE(sensors));
+    bench_report("aht10.log_bytes_per_sample", log_bytes / ARRAY_SIZE(sensors));
+    printk("Benchmark complete\n\n");
 }
 
-// Function to scan I2C bus (from your original code)
-void scan_i2c_bus(void)
+#ifdef CONFIG_I2C_SPEED
+// Function to time the bus traffic of one sample at every speed up to the
+// configured maximum, on the first sensor's bus
+void benchmark_bus_speeds(void)
 {
-    uint8_t dummy_data = 0;
-    int ret;
-    int devices_found = 0;
+    const struct device *bus = sensors[0].bus;
+    uint8_t trigger_cmd[3] = {AHT10_CMD_TRIGGER, AHT10_TRIGGER_PARAM0, AHT10_TRIGGER_PARAM1};
+    uint8_t frame[AHT10_DATA_LEN];
+    // Same traffic as a full-frame sample: trigger, then status + data
+    struct i2c_msg msgs[] = {
+        {.buf = trigger_cmd, .len = sizeof(trigger_cmd), .flags = I2C_MSG_WRITE | I2C_MSG_STOP},
+        {.buf = frame, .len = sizeof(frame), .flags = I2C_MSG_READ | I2C_MSG_STOP},
+    };
+    struct i2c_speed_target targets[ARRAY_SIZE(sensors)];
+    struct i2c_speed_bench bench;
+    uint32_t saved_config;
+    char metric[48];
     
-    printk("Starting I2C bus scan...\n");
-    printk("Scanning addresses 0x08 to 0x77\n");
-    printk("     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n");
+    if (i2c_get_config(bus, &saved_config) != 0) {
+        return;
+    }
     
-    for (int addr = 0; addr < 128; addr++) {
-        // Print address row header
-        if (addr % 16 == 0) {
-            printk("%02x: ", addr);
+    // The first sensor is the first target on its bus
+    bus_targets(bus, targets);
+    printk("Bus speed benchmark: %d sample sequence(s) per speed\n", BUS_BENCH_REPS);
+    
+    for (uint32_t speed = I2C_SPEED_STANDARD; speed <= CONFIG_APP_I2C_MAX_SPEED; speed++) {
+        if (i2c_configure(bus, I2C_SPEED_SET(speed) | I2C_MODE_CONTROLLER) != 0) {
+            printk("  %7u Hz: not supported by controller\n", i2c_speed_to_bitrate(speed));
+            continue;
         }
         
-        // Skip reserved addresses
-        if (addr < 0x08 || addr > 0x77) {
-            printk("   ");
-        } else {
-            // Try to communicate with device at this address
-            ret = i2c_write(i2c_dev, &dummy_data, 0, addr);
-            
-            if (ret == 0) {
-                // Device found
-                printk("%02x ", addr);
-                devices_found++;
-            } else {
-                // No device at this address  
-                printk("-- ");
-            }
+        if (i2c_speed_check(bus, &targets[0]) != 0) {
+            printk("  %7u Hz: sensor fails the integrity check\n", i2c_speed_to_bitrate(speed));
+            continue;
         }
         
-        // Print newline at end of row
-        if ((addr + 1) % 16 == 0) {
-            printk("\n");
+        if (i2c_speed_bench_run(bus, targets[0].addr, msgs, ARRAY_SIZE(msgs),
+                                BUS_BENCH_REPS, &bench) != 0) {
+            continue;
         }
         
-        // Small delay between scans
-        k_msleep(1);
+        printk("  %7u Hz: %u transfers/s, %u us bus time per sample\n",
+               bench.bitrate, bench.transfers_per_sec, bench.sequence_us);
+        
+        snprintk(metric, sizeof(metric), "aht10.i2c_%uhz.transfers_per_sec", bench.bitrate);
+        bench_report(metric, bench.transfers_per_sec);
+        snprintk(metric, sizeof(metric), "aht10.i2c_%uhz.sample_bus_us", bench.bitrate);
+        bench_report(metric, bench.sequence_us);
     }
     
-    printk("\nScan complete. Found %d device(s).\n\n", devices_found);
+    // Back to the negotiated speed; let the last trigger's conversion end
+    i2c_configure(bus, saved_config);
+    k_msleep(100);
 }
+#endif
+#endif
 
 int main(void)
 {
-    float temperature, humidity;
+    struct aht10_sched_stats stats;
+    uint32_t rounds = 0;
+    int reported;
     int ret;
+#ifdef CONFIG_APP_WATCHDOG
+    int wdt_channel;
+#endif
     
     printk("STM32F411CEU6 BlackPill AHT10 Temperature & Humidity Reader\n");
     printk("==========================================================\n");
     
     // Get I2C device
-    i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c1));
+    i2c_dev = DEVICE_DT_GET(DT_BUS(AHT10_NODE));
     if (!device_is_ready(i2c_dev)) {
         printk("ERROR: I2C device not ready\n");
         return -1;
@@ -195,36 +355,104 @@ int main(void)
     // Scan I2C bus first to verify AHT10 is detected
     scan_i2c_bus();
     
-    // Initialize AHT10 sensor
-    ret = aht10_init();
+#ifdef CONFIG_I2C_SPEED
+    // Buses boot at the devicetree speed; go faster where it holds up
+    negotiate_bus_speeds();
+#endif
+    
+    // The driver resets and calibrates each sensor at boot
+    for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+        if (!device_is_ready(sensors[i].dev)) {
+            printk("ERROR: Failed to initialize AHT10 sensor %s\n", sensors[i].dev->name);
+            return -1;
+        }
+    }
+    
+    // One worker per bus; every round triggers all sensors before collecting
+    ret = aht10_sched_init(sensors, ARRAY_SIZE(sensors));
     if (ret != 0) {
-        printk("ERROR: Failed to initialize AHT10 sensor\n");
+        printk("ERROR: Failed to set up the acquisition scheduler (error: %d)\n", ret);
+        return -1;
+    }
+    
+#ifdef CONFIG_DEADBAND_REPORT
+    // Only print readings that moved, plus a heartbeat now and then
+    for (size_t i = 0; i < ARRAY_SIZE(gates); i++) {
+        deadband_init(&gates[i], CONFIG_DEADBAND_TEMP_CENTI, CONFIG_DEADBAND_HUMIDITY_CENTI,
+                      CONFIG_DEADBAND_HEARTBEAT_SEC * MSEC_PER_SEC);
+    }
+#endif
+    
+    printk("AHT10 sensor ready (%d instance(s) on %d bus(es))\n",
+           (int)ARRAY_SIZE(sensors), (int)aht10_sched_bus_count());
+    
+#ifdef CONFIG_APP_BENCHMARK
+    benchmark_rounds(bench_uptime_us());
+#ifdef CONFIG_I2C_SPEED
+    benchmark_bus_speeds();
+#endif
+#endif
+    
+#ifdef CONFIG_APP_WATCHDOG
+    // The loop below must come round within the timeout; the hardware
+    // watchdog, where there is one, catches the task watchdog itself
+    ret = task_wdt_init(DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0)));
+    wdt_channel = (ret == 0) ? task_wdt_add(CONFIG_APP_WATCHDOG_TIMEOUT_MS, NULL, NULL) : ret;
+    if (wdt_channel < 0) {
+        printk("ERROR: Failed to set up the watchdog (error: %d)\n", wdt_channel);
         return -1;
     }
+    printk("Watchdog: %d ms\n", CONFIG_APP_WATCHDOG_TIMEOUT_MS);
+#endif
     
     printk("Starting temperature and humidity readings...\n");
     printk("============================================\n\n");
     
+    // The first tick is now; the rest follow at fixed multiples of the
+    // period, so round and output time don't add up to drift
+    sample_clock_start(&round_clock, CONFIG_APP_SAMPLE_PERIOD_MS);
+    
     while (1) {
-        // Read temperature and humidity
-        ret = aht10_read_data(&temperature, &humidity);
+#ifdef CONFIG_APP_WATCHDOG
+        // Fed while waiting too, so periods longer than the timeout work
+        while (sample_clock_wait(&round_clock, K_MSEC(CONFIG_APP_WATCHDOG_TIMEOUT_MS / 2)) != 0) {
+            task_wdt_feed(wdt_channel);
+        }
+        task_wdt_feed(wdt_channel);
+#else
+        sample_clock_wait(&round_clock, K_FOREVER);
+#endif
+        
+        // Read all sensors with their conversion windows overlapped
+        ret = aht10_sched_run(results, K_MSEC(500));
         
-        if (ret == 0) {
-            // Convert to integers for display (multiply by 100 to keep 2 decimal places)
-            int temp_int = (int)(temperature * 100);
-            int humid_int = (int)(humidity * 100);
-            
-            printk("Temperature: %d.%02d°C\n", temp_int / 100, temp_int % 100);
-            printk("Humidity: %d.%02d%%\n", humid_int / 100, humid_int % 100);
-            printk("Raw temp: %d, Raw humid: %d\n", temp_int, humid_int);
-            printk("------------------------\n");
-        } else {
-            printk("ERROR: Failed to read AHT10 data (error: %d)\n", ret);
+        reported = 0;
+        for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+            if (results[i].err == 0) {
+                sample_clock_record(&round_clock, results[i].sample.timestamp_us);
+                if (should_report(i, &results[i].sample)) {
+                    print_reading(sensors[i].dev, &results[i].sample);
+                    reported++;
+                }
+            } else {
+                LOG_ERR("Failed to read %s (error: %d)", sensors[i].dev->name,
+                        results[i].err);
+            }
+        }
+        
+        // Round time covers all sensors, not one conversion per sensor
+        if (!IS_ENABLED(CONFIG_DEADBAND_REPORT) || reported > 0) {
+            aht10_sched_get_stats(&stats);
+            LOG_INF("Round: %d sample(s) in %u us (%u samples/s)",
+                    ret, stats.last_round_us, stats.samples_per_sec);
         }
         
-        // Wait 2 seconds before next reading
-        k_sleep(K_SECONDS(2));
+        if (++rounds % REPORT_STATS_INTERVAL == 0) {
+            print_report_stats();
+            print_fault_stats();
+            print_schedule_stats();
+        }
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -5,298 +5,1833 @@
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/logging/log.h>
+#include <app/lib/i2c_scan.h>
+#include <app/lib/i2c_speed.h>
+#include <zephyr/drivers/sensor.h>
+#include <app/drivers/sensor/aht10.h>
+#include <app/lib/fixedpoint.h>
+#include <app/lib/serial_tx.h>
+#include <app/lib/telemetry.h>
+#include <app/lib/stream_stats.h>
+#include <app/lib/deadband.h>
+#include <app/lib/sample_log.h>
+#include <app/lib/latency.h>
+#include <app/lib/bench.h>
+#include <app/lib/sample_clock.h>
+#include <zephyr/zbus/zbus.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/task_wdt/task_wdt.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
-LOG_MODULE_REGISTER(aht10_reader, LOG_LEVEL_INF);
+LOG_MODULE_REGISTER(aht10_reader, CONFIG_APP_LOG_LEVEL);
 
-// AHT10 I2C address
-#define AHT10_I2C_ADDR 0x38
+// AHT10 sensor node from the devicetree overlay
+#define AHT10_NODE DT_NODELABEL(aht10)
 
-// AHT10 Commands
-#define AHT10_CMD_INIT          0xE1
-#define AHT10_CMD_TRIGGER       0xAC
-#define AHT10_CMD_SOFT_RESET    0xBA
-#define AHT10_STATUS_BUSY       0x80
-#define AHT10_STATUS_CALIBRATED 0x08
+// Default thresholds for LED control (hundredths of °C / %RH); the
+// "aht10 thresh" shell command changes them at runtime
+#define TEMP_LOW_THRESHOLD      2000    // Below 20.00°C: Blue LED
+#define TEMP_HIGH_THRESHOLD     2500    // Above 25.00°C: Red LED
+#define HUMIDITY_HIGH_THRESHOLD 6000    // Above 60.00%: Green LED
 
-// Temperature and humidity thresholds for LED control
-#define TEMP_LOW_THRESHOLD      20.0f   // Below this: Blue LED
-#define TEMP_HIGH_THRESHOLD     25.0f   // Above this: Red LED
-#define HUMIDITY_HIGH_THRESHOLD 60.0f   // Above this: Green LED
+// Sampling period limits for "aht10 period" (milliseconds)
+#define PERIOD_MIN_MS           100
+#define PERIOD_MAX_MS           3600000
+
+// UART used for the data output (falls back to the console UART)
+#if DT_HAS_CHOSEN(app_telemetry_uart)
+#define TELEMETRY_UART_NODE DT_CHOSEN(app_telemetry_uart)
+#else
+#define TELEMETRY_UART_NODE DT_CHOSEN(zephyr_console)
+#endif
+
+// printk and the log backend write to the console UART behind the TX
+// ring's back: if it is also the data UART, it must never be suspended
+// and binary frames would be corrupted, so it stays on and in text mode
+#if DT_HAS_CHOSEN(zephyr_console) && \
+    DT_SAME_NODE(TELEMETRY_UART_NODE, DT_CHOSEN(zephyr_console))
+#define TELEMETRY_UART_IS_CONSOLE 1
+#else
+#define TELEMETRY_UART_IS_CONSOLE 0
+#endif
+#define OUTPUT_BINARY_ALLOWED   (IS_ENABLED(CONFIG_TELEMETRY_FRAME) && !TELEMETRY_UART_IS_CONSOLE)
+
+// Print UART TX statistics every this many samples
+#define UART_STATS_INTERVAL     10
+
+// Acquisition runs at high priority and only ever touches the sensor and
+// the sample ring. LEDs, console, UART and flash are zbus observers, each
+// with a low-priority thread of its own, so no consumer can stretch the
+// sampling period or hold up another consumer.
+#define ACQ_STACK_SIZE          1024
+#define OBSERVER_STACK_SIZE     1024
+#define UART_STACK_SIZE         2048
+
+// Notices an observer can have pending before further ones are dropped
+// (harmless: every notice covers all records up to its head)
+#define OBSERVER_QUEUE_SIZE     4
+
+// One acquisition as the observers see it
+struct sample_record {
+    atomic_t seq;                   // Sequence number; changes when the slot is reused
+    atomic_t readers;               // Observers handling the record in place
+    struct telemetry_sample sample;
+#ifdef CONFIG_APP_OVERSAMPLE
+    struct telemetry_aggregate agg; // The window summary
+#endif
+    int err;                        // 0, or why the read failed
+    bool report;                    // Passed report-on-change: goes to console and UART
+};
+
+// Broadcast ring. The acquisition thread writes records in order and never
+// waits; every observer handles them in place at its own pace, with its
+// own cursor. An observer pins a slot while it handles the record: the
+// acquisition thread first invalidates a slot it is about to reuse and
+// then backs off if the slot is pinned, dropping the new reading instead
+// (counted as pinned drops). So nothing is copied per observer and no
+// record changes under a handler. An observer that falls a whole ring
+// behind loses its oldest records (overruns) without affecting anyone
+// else.
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_APP_SAMPLE_QUEUE_SIZE),
+             "CONFIG_APP_SAMPLE_QUEUE_SIZE must be a power of two");
+static struct sample_record sample_ring[CONFIG_APP_SAMPLE_QUEUE_SIZE];
+static atomic_t sample_head;        // Sequence number of the next record
+static atomic_t queue_high_water;   // Peak backlog of the slowest observer
+static uint32_t pinned_drops;       // Readings dropped because their slot was pinned
+
+// What goes over zbus: how far the ring is filled, not the samples
+struct sample_notice {
+    uint32_t head;                  // Records before this one are ready
+    uint32_t cycles;                // k_cycle_get_32() when published
+};
+
+ZBUS_CHAN_DEFINE(sample_chan, struct sample_notice, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+                 ZBUS_MSG_INIT(0));
+static atomic_t notice_failures;    // Notices some observer's queue had no room for
+
+// Per-observer bookkeeping, only written by the observer's own thread
+struct sample_observer {
+    const char *name;
+    const struct zbus_observer *sub;
+    uint32_t cursor;                // Next record to handle
+    uint32_t handled;
+    uint32_t overruns;              // Records reused before they were handled
+    uint32_t batches;               // Wakeups that found records to handle
+    uint32_t latency_max_us;        // Notice published until its records were handled
+    uint64_t latency_total_us;
+    void (*handle)(const struct sample_record *rec);
+};
+
+void store_record(const struct sample_record *rec);
+void led_record(const struct sample_record *rec);
+void console_record(const struct sample_record *rec);
+void uart_record(const struct sample_record *rec);
+
+// Observers in notification order: flash first, so a record is stored
+// before anything that reports on the log sees it
+#ifdef CONFIG_APP_SAMPLE_LOG
+ZBUS_SUBSCRIBER_DEFINE(store_sub, OBSERVER_QUEUE_SIZE);
+ZBUS_CHAN_ADD_OBS(sample_chan, store_sub, 1);
+static struct sample_observer store_obs = {
+    .name = "store", .sub = &store_sub, .handle = store_record,
+};
+#endif
+ZBUS_SUBSCRIBER_DEFINE(led_sub, OBSERVER_QUEUE_SIZE);
+ZBUS_CHAN_ADD_OBS(sample_chan, led_sub, 2);
+static struct sample_observer led_obs = {
+    .name = "leds", .sub = &led_sub, .handle = led_record,
+};
+ZBUS_SUBSCRIBER_DEFINE(console_sub, OBSERVER_QUEUE_SIZE);
+ZBUS_CHAN_ADD_OBS(sample_chan, console_sub, 3);
+static struct sample_observer console_obs = {
+    .name = "console", .sub = &console_sub, .handle = console_record,
+};
+ZBUS_SUBSCRIBER_DEFINE(uart_sub, OBSERVER_QUEUE_SIZE);
+ZBUS_CHAN_ADD_OBS(sample_chan, uart_sub, 4);
+static struct sample_observer uart_obs = {
+    .name = "uart", .sub = &uart_sub, .handle = uart_record,
+};
+
+static struct sample_observer *const observers[] = {
+#ifdef CONFIG_APP_SAMPLE_LOG
+    &store_obs,
+#endif
+    &led_obs,
+    &console_obs,
+    &uart_obs,
+};
+
+// Per-stage timing of a sample (CONFIG_LATENCY_PROBES, "latency show")
+LATENCY_HIST_DEFINE(app_sample_fetch);
+LATENCY_HIST_DEFINE(app_convert);
+LATENCY_HIST_DEFINE(app_led_update);
+LATENCY_HIST_DEFINE(app_format);
+LATENCY_HIST_DEFINE(app_uart_tx);
+
+#ifdef CONFIG_APP_BENCHMARK
+// Benchmark figures. The acquisition loop maximum is only written by the
+// acquisition thread, the log bytes by the console observer and the rest
+// by the UART observer.
+static uint32_t bench_ready_us;         // Boot until the threads start
+static uint32_t bench_bytes_start;      // UART bytes queued before that
+static uint32_t bench_acq_max_us;
+static uint32_t bench_output_max_us;
+static uint64_t bench_output_total_us;
+static uint32_t bench_log_bytes;        // Queued for the log thread
+#endif
+
+// Thread wakeups: one per acquisition period, one per published notice
+// (all observers run off the same wakeup)
+static atomic_t acq_wakeups;
+static atomic_t output_wakeups;
+
+// Slowest sensor read so far, failed and recovering ones included; only
+// written by the acquisition thread
+static uint32_t sample_max_us;
+
+// Boot until the first good sample's conversion completed (0: none yet)
+static uint32_t first_sample_us;
+
+// Runs once the first sample is in: reports how long that took and, in
+// fast-boot mode, does the setup main() left out (settings, bus speed,
+// flash log, bus scan, LED test). Its own queue, below the observers:
+// the LED test sleeps for 1.5 s and the system work queue runs the
+// sensor's state machine.
+#define BOOT_WORK_STACK_SIZE    2048
+K_THREAD_STACK_DEFINE(boot_work_stack, BOOT_WORK_STACK_SIZE);
+static struct k_work_q boot_workq;
+void boot_work_handler(struct k_work *work);
+static K_WORK_DEFINE(boot_work, boot_work_handler);
+
+// The LED test and the LED observer take turns
+static K_MUTEX_DEFINE(led_lock);
+
+// Readings and the boot work's bus speed negotiation and scan take turns
+static K_MUTEX_DEFINE(bus_lock);
+
+#ifdef CONFIG_APP_WATCHDOG
+// Task watchdog channel the acquisition thread feeds
+static int acq_wdt_channel;
+#endif
+
+#ifdef CONFIG_APP_LOW_POWER
+// A device under runtime PM, with how often and how long it was resumed.
+// Several threads may hold it at once; only the first get and the last
+// put count.
+struct power_domain {
+    const char *name;
+    const struct device *dev;
+    bool managed;                   // Runtime PM enabled on it
+    struct k_spinlock lock;
+    uint32_t users;
+    uint32_t resumes;
+    int64_t on_since;
+    int64_t on_ms;
+};
+
+static struct power_domain i2c_power = {.name = "I2C"};
+static struct power_domain uart_power = {.name = "UART"};
+#endif
+
+// Runtime configuration. Each value is a single atomic, so the threads
+// just load it: a shell command never holds anything the acquisition
+// thread could wait on.
+struct app_config {
+    atomic_t period_ms;             // Sampling period
+    atomic_t temp_low;              // Blue LED below this (hundredths)
+    atomic_t temp_high;             // Red LED above this
+    atomic_t humidity_high;         // Green LED above this
+    atomic_t binary;                // 1: COBS frames, 0: JSON and text
+};
+
+static struct app_config app_cfg = {
+    .period_ms = ATOMIC_INIT(CONFIG_APP_SAMPLE_PERIOD_MS),
+    .temp_low = ATOMIC_INIT(TEMP_LOW_THRESHOLD),
+    .temp_high = ATOMIC_INIT(TEMP_HIGH_THRESHOLD),
+    .humidity_high = ATOMIC_INIT(HUMIDITY_HIGH_THRESHOLD),
+    .binary = ATOMIC_INIT(IS_ENABLED(CONFIG_APP_OUTPUT_BINARY) && OUTPUT_BINARY_ALLOWED),
+};
+
+// Acquisition schedule: a tick every period_ms, drift-free. A new period
+// from the shell restarts it, cutting a long wait short.
+static struct sample_clock acq_clock;
+
+// One persisted parameter: settings key "app/<name>" and its valid range
+struct app_param {
+    const char *name;
+    atomic_t *value;
+    int32_t min;
+    int32_t max;
+};
+
+static const struct app_param app_params[] = {
+    {"period", &app_cfg.period_ms, PERIOD_MIN_MS, PERIOD_MAX_MS},
+    {"temp_low", &app_cfg.temp_low, -5000, 15000},
+    {"temp_high", &app_cfg.temp_high, -5000, 15000},
+    {"humidity", &app_cfg.humidity_high, 0, 10000},
+    {"format", &app_cfg.binary, 0, OUTPUT_BINARY_ALLOWED},
+};
+
+#ifdef CONFIG_APP_OVERSAMPLE
+// Filter applied to every reading in oversampling mode
+#if defined(CONFIG_APP_FILTER_MOVING_AVG)
+#define OVERSAMPLE_FILTER       STREAM_FILTER_MOVING_AVG
+#define OVERSAMPLE_FILTER_PARAM CONFIG_APP_FILTER_TAPS
+#elif defined(CONFIG_APP_FILTER_MEDIAN)
+#define OVERSAMPLE_FILTER       STREAM_FILTER_MEDIAN
+#define OVERSAMPLE_FILTER_PARAM CONFIG_APP_FILTER_TAPS
+#elif defined(CONFIG_APP_FILTER_EMA)
+#define OVERSAMPLE_FILTER       STREAM_FILTER_EMA
+#define OVERSAMPLE_FILTER_PARAM CONFIG_APP_FILTER_EMA_SHIFT
+#else
+#define OVERSAMPLE_FILTER       STREAM_FILTER_NONE
+#define OVERSAMPLE_FILTER_PARAM 0
+#endif
+
+// Filter state runs across windows; statistics restart every window
+static struct stream_filter temp_filter, humid_filter;
+static struct stream_stats temp_stats, humid_stats;
+#endif
+
+#ifdef CONFIG_DEADBAND_REPORT
+// Report-on-change gate for the console and UART output. Applied once,
+// when a record is published, so both observers report the same readings.
+static struct deadband report_gate;
+#endif
+
+#ifdef CONFIG_APP_SAMPLE_LOG
+// Host command on the data UART: replay the flash log
+#define LOG_DRAIN_COMMAND       'D'
+
+// Set from the UART ISR when the host asks for the log, or by the store
+// observer every CONFIG_APP_SAMPLE_LOG_DRAIN_INTERVAL samples
+static atomic_t drain_requested;
+
+// Set once the log is mounted (after the first sample, with fast boot)
+static atomic_t log_ready;
+#endif
 
 // GPIO LED definitions (adjust pins according to your setup)
 #define LED_RED_NODE    DT_ALIAS(led0)      // Red LED - High temperature
 #define LED_GREEN_NODE  DT_ALIAS(led1)      // Green LED - High humidity  
 #define LED_BLUE_NODE   DT_ALIAS(led2)      // Blue LED - Low temperature
 
-// Device pointers
-static const struct device *i2c_dev;
-static const struct device *uart_dev;
+// LED state bits, in the order of the LED tables below
+#define LED_RED         BIT(0)
+#define LED_GREEN       BIT(1)
+#define LED_BLUE        BIT(2)
+#define LED_COUNT       3
+
+// Device pointers
+static const struct device *const aht10_dev = DEVICE_DT_GET(AHT10_NODE);
+static const struct device *i2c_dev;
+static const struct device *uart_dev;
+
+#ifdef CONFIG_APP_LED_PWM
+// Brightness steps: how far past its threshold the reading is
+#define LED_PWM_STEPS   16
+
+// PWM LED specifications (pwm-led0..2 aliases)
+static const struct pwm_dt_spec leds[LED_COUNT] = {
+    PWM_DT_SPEC_GET(DT_ALIAS(pwm_led0)),
+    PWM_DT_SPEC_GET(DT_ALIAS(pwm_led1)),
+    PWM_DT_SPEC_GET(DT_ALIAS(pwm_led2)),
+};
+static uint8_t led_levels[LED_COUNT];   // Levels currently programmed
+#else
+// GPIO LED specifications
+static const struct gpio_dt_spec leds[LED_COUNT] = {
+    GPIO_DT_SPEC_GET(LED_RED_NODE, gpios),
+    GPIO_DT_SPEC_GET(LED_GREEN_NODE, gpios),
+    GPIO_DT_SPEC_GET(LED_BLUE_NODE, gpios),
+};
+static uint8_t led_outputs;             // LED_* bits currently driven
+#endif
+
+static const char *const led_names[LED_COUNT] = {"Red", "Green", "Blue"};
+
+static uint8_t led_state;               // LED_* bits the state machine wants lit
+static uint32_t led_writes;             // Hardware writes
+static uint32_t led_samples;            // Readings evaluated
+
+// Function to initialize the LEDs
+int init_leds(void)
+{
+    int ret;
+    
+    printk("Initializing LEDs...\n");
+    
+    for (size_t i = 0; i < LED_COUNT; i++) {
+#ifdef CONFIG_APP_LED_PWM
+        if (!pwm_is_ready_dt(&leds[i])) {
+            printk("ERROR: %s LED PWM device not ready\n", led_names[i]);
+            return -1;
+        }
+        ret = pwm_set_pulse_dt(&leds[i], 0);
+        if (ret < 0) {
+            printk("ERROR: Failed to configure %s LED PWM\n", led_names[i]);
+            return ret;
+        }
+#else
+        if (!gpio_is_ready_dt(&leds[i])) {
+            printk("ERROR: %s LED GPIO device not ready\n", led_names[i]);
+            return -1;
+        }
+        ret = gpio_pin_configure_dt(&leds[i], GPIO_OUTPUT_INACTIVE);
+        if (ret < 0) {
+            printk("ERROR: Failed to configure %s LED GPIO\n", led_names[i]);
+            return ret;
+        }
+#endif
+    }
+    
+    printk("LEDs initialized successfully\n");
+    return 0;
+}
+
+#ifdef CONFIG_APP_LED_PWM
+// Function to set LED brightness; @levels (NULL: full) are 1..LED_PWM_STEPS
+// for lit LEDs. Only changed channels hit the hardware.
+void write_leds(uint8_t state, const uint8_t *levels)
+{
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        uint8_t level = 0;
+        
+        if (state & BIT(i)) {
+            level = (levels != NULL) ? levels[i] : LED_PWM_STEPS;
+        }
+        
+        if (level != led_levels[i]) {
+            pwm_set_pulse_dt(&leds[i], leds[i].period * level / LED_PWM_STEPS);
+            led_levels[i] = level;
+            led_writes++;
+        }
+    }
+}
+
+// Function to map how far past its threshold a reading is to a level
+uint8_t led_level(int32_t excess)
+{
+    int32_t level = 1 + excess * (LED_PWM_STEPS - 1) / CONFIG_APP_LED_PWM_FULL_SCALE;
+    
+    return CLAMP(level, 1, LED_PWM_STEPS);
+}
+#else
+// Function to switch LEDs on/off. Only changed LEDs are written, with one
+// gpio_port_set_masked() per port, so LEDs sharing a port switch together.
+void write_leds(uint8_t state, const uint8_t *levels)
+{
+    uint8_t changed = state ^ led_outputs;
+    
+    ARG_UNUSED(levels);
+    
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        gpio_port_pins_t mask = 0;
+        gpio_port_value_t value = 0;
+        
+        if (!(changed & BIT(i))) {
+            continue;
+        }
+        
+        // Collect every changed LED on this LED's port
+        for (size_t j = i; j < LED_COUNT; j++) {
+            if ((changed & BIT(j)) && leds[j].port == leds[i].port) {
+                mask |= BIT(leds[j].pin);
+                if (state & BIT(j)) {
+                    value |= BIT(leds[j].pin);
+                }
+                changed &= ~BIT(j);
+            }
+        }
+        
+        // Logical levels: the driver inverts active-low pins
+        gpio_port_set_masked(leds[i].port, mask, value);
+        led_writes++;
+    }
+    
+    led_outputs = state;
+}
+#endif
+
+// Function to step one hysteresis state: switch on above @on, and back
+// off only once the value drops below @off
+bool hysteresis(bool active, int32_t value, int32_t on, int32_t off)
+{
+    return active ? (value >= off) : (value > on);
+}
+
+// Function to print the LED state (only called when it changes)
+void print_led_status(uint8_t state)
+{
+    if (state & LED_RED) {
+        LOG_INF("LED Status: RED (High Temperature)");
+    }
+    if (state & LED_BLUE) {
+        LOG_INF("LED Status: BLUE (Low Temperature)");
+    }
+    if (state & LED_GREEN) {
+        LOG_INF("LED Status: GREEN (High Humidity)");
+    }
+    if (state == 0) {
+        LOG_INF("LED Status: All OFF (Normal conditions)");
+    }
+}
+
+// Function to control LEDs based on temperature and humidity (in hundredths).
+// Each LED has a hysteresis band inside its threshold, so readings hovering
+// around a threshold don't make it flicker, and the hardware is only
+// written when something changes.
+void control_leds(int32_t temperature, int32_t humidity)
+{
+    int32_t temp_low = atomic_get(&app_cfg.temp_low);
+    int32_t temp_high = atomic_get(&app_cfg.temp_high);
+    int32_t humidity_high = atomic_get(&app_cfg.humidity_high);
+    uint8_t levels[LED_COUNT] = {0};
+    uint8_t state = 0;
+    
+    LATENCY_START(start);
+    
+    if (hysteresis(led_state & LED_RED, temperature, temp_high,
+                   temp_high - CONFIG_APP_LED_HYSTERESIS_TEMP)) {
+        state |= LED_RED;       // Red LED for high temperature
+    } else if (hysteresis(led_state & LED_BLUE, -temperature, -temp_low,
+                          -(temp_low + CONFIG_APP_LED_HYSTERESIS_TEMP))) {
+        state |= LED_BLUE;      // Blue LED for low temperature
+    }
+    
+    if (hysteresis(led_state & LED_GREEN, humidity, humidity_high,
+                   humidity_high - CONFIG_APP_LED_HYSTERESIS_HUMIDITY)) {
+        state |= LED_GREEN;     // Green LED for high humidity
+    }
+    
+#ifdef CONFIG_APP_LED_PWM
+    // Brightness shows how far past the threshold the reading is
+    levels[0] = led_level(temperature - temp_high);
+    levels[1] = led_level(humidity - humidity_high);
+    levels[2] = led_level(temp_low - temperature);
+#endif
+    
+    led_samples++;
+    write_leds(state, levels);
+    LATENCY_END(app_led_update, start);
+    
+    if (state != led_state || led_samples == 1) {
+        print_led_status(state);
+        led_state = state;
+    }
+}
+
+// Function to print how often the LEDs were actually written
+void print_led_stats(void)
+{
+    printk("LEDs: %u write(s) over %u sample(s)\n", led_writes, led_samples);
+}
+
+// Function to light each LED in turn (1.5 s). Afterwards all are off until
+// the next reading sets them again.
+void test_leds(void)
+{
+    k_mutex_lock(&led_lock, K_FOREVER);
+    printk("Testing LEDs...\n");
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        write_leds(BIT(i), NULL);
+        k_msleep(500);
+    }
+    write_leds(0, NULL);
+    led_writes = 0;
+    printk("LED test complete\n");
+    k_mutex_unlock(&led_lock);
+}
+
+// Function to send data via UART
+void send_uart_data(const struct telemetry_sample *sample)
+{
+#ifdef CONFIG_TELEMETRY_FRAME
+    if (atomic_get(&app_cfg.binary)) {
+        static uint16_t seq;
+        uint8_t frame[TELEMETRY_FRAME_MAX_LEN];
+        size_t len;
+        
+        // One COBS frame: sequence, timestamp, raw readings and CRC16
+        LATENCY_START(format_start);
+        len = telemetry_encode_sample(sample, seq++, frame);
+        LATENCY_END(app_format, format_start);
+        
+        LATENCY_START(tx_start);
+        serial_tx_write(frame, len);
+        LATENCY_END(app_uart_tx, tx_start);
+        return;
+    }
+#endif
+    
+    char uart_buffer[128];
+    char temp_str[FIXEDPOINT_CENTI_STR_LEN];
+    char humid_str[FIXEDPOINT_CENTI_STR_LEN];
+    int64_t timestamp_ms = sample->timestamp_us / 1000;
+    unsigned long long timestamp_us = sample->timestamp_us;
+    int len;
+    
+    LATENCY_START(format_start);
+    
+    // Integer-only formatting, no float printf support needed
+    fixedpoint_centi_to_str(aht10_raw_to_centi_celsius(sample->raw_temperature), temp_str);
+    fixedpoint_centi_to_str(aht10_raw_to_centi_percent(sample->raw_humidity), humid_str);
+    
+    // Format the data as JSON for easier parsing
+    len = snprintf(uart_buffer, sizeof(uart_buffer),
+                   "{\"temperature\":%s,\"humidity\":%s,\"timestamp\":%lld,"
+                   "\"timestamp_us\":%llu}\r\n",
+                   temp_str, humid_str, timestamp_ms, timestamp_us);
+    LATENCY_END(app_format, format_start);
+    
+    // Queue for the UART TX interrupt; returns without waiting for the line
+    LATENCY_START(tx_start);
+    serial_tx_write(uart_buffer, len);
+    LATENCY_END(app_uart_tx, tx_start);
+    
+    // Also send human-readable format
+    len = snprintf(uart_buffer, sizeof(uart_buffer),
+                   "TEMP: %s°C, HUMID: %s%%, TIME: %lluus\r\n",
+                   temp_str, humid_str, timestamp_us);
+    
+    serial_tx_write(uart_buffer, len);
+}
+
+#ifdef CONFIG_APP_OVERSAMPLE
+// Function to format one channel's window statistics as JSON
+int format_channel_json(char *buf, size_t size, const char *name,
+                        const struct telemetry_channel_stats *ch)
+{
+    char str[5][FIXEDPOINT_CENTI_STR_LEN];
+    
+    fixedpoint_centi_to_str(ch->value, str[0]);
+    fixedpoint_centi_to_str(ch->mean, str[1]);
+    fixedpoint_centi_to_str(ch->min, str[2]);
+    fixedpoint_centi_to_str(ch->max, str[3]);
+    fixedpoint_centi_to_str(ch->stddev, str[4]);
+    
+    return snprintf(buf, size,
+                    "\"%s\":{\"value\":%s,\"mean\":%s,\"min\":%s,\"max\":%s,\"stddev\":%s}",
+                    name, str[0], str[1], str[2], str[3], str[4]);
+}
+
+// Function to send one oversampling window via UART
+void send_uart_aggregate(const struct telemetry_aggregate *agg)
+{
+#ifdef CONFIG_TELEMETRY_FRAME
+    if (atomic_get(&app_cfg.binary)) {
+        static uint16_t seq;
+        uint8_t frame[TELEMETRY_FRAME_MAX_LEN];
+        size_t len;
+        
+        // One 37-byte frame per window instead of one frame per sample
+        len = telemetry_encode_aggregate(agg, seq++, frame);
+        serial_tx_write(frame, len);
+        return;
+    }
+#endif
+    
+    char uart_buffer[256];
+    int len;
+    
+    // Single JSON line per window
+    len = snprintf(uart_buffer, sizeof(uart_buffer), "{\"count\":%u,", agg->count);
+    len += format_channel_json(uart_buffer + len, sizeof(uart_buffer) - len,
+                               "temperature", &agg->temperature);
+    len += snprintf(uart_buffer + len, sizeof(uart_buffer) - len, ",");
+    len += format_channel_json(uart_buffer + len, sizeof(uart_buffer) - len,
+                               "humidity", &agg->humidity);
+    len += snprintf(uart_buffer + len, sizeof(uart_buffer) - len,
+                    ",\"timestamp\":%lld,\"timestamp_us\":%llu}\r\n",
+                    (long long)(agg->timestamp_us / 1000),
+                    (unsigned long long)agg->timestamp_us);
+    
+    if (len < (int)sizeof(uart_buffer)) {
+        serial_tx_write(uart_buffer, len);
+    }
+}
+
+// Function to log one channel's window statistics
+void print_channel(const char *name, const char *unit,
+                   const struct telemetry_channel_stats *ch)
+{
+    LOG_INF("%s: " FIXEDPOINT_CENTI_FMT "%s (mean " FIXEDPOINT_CENTI_FMT
+            ", sd " FIXEDPOINT_CENTI_FMT ", range " FIXEDPOINT_CENTI_FMT
+            ".." FIXEDPOINT_CENTI_FMT ")",
+            name, FIXEDPOINT_CENTI_ARGS(ch->value), unit,
+            FIXEDPOINT_CENTI_ARGS(ch->mean), FIXEDPOINT_CENTI_ARGS(ch->stddev),
+            FIXEDPOINT_CENTI_ARGS(ch->min), FIXEDPOINT_CENTI_ARGS(ch->max));
+}
+
+// Function to fill one channel's summary and start a new window
+void close_channel(struct telemetry_channel_stats *ch, struct stream_stats *stats)
+{
+    ch->mean = stream_stats_mean(stats);
+    ch->stddev = stream_stats_stddev(stats);
+    ch->min = stats->min;
+    ch->max = stats->max;
+    stream_stats_reset(stats);
+}
+
+// Function to fold one reading into the current window. Returns true
+// (and fills @agg) when the window is complete.
+bool oversample_add(const struct telemetry_sample *sample, struct telemetry_aggregate *agg)
+{
+    int32_t temperature = aht10_raw_to_centi_celsius(sample->raw_temperature);
+    int32_t humidity = aht10_raw_to_centi_percent(sample->raw_humidity);
+    
+    agg->temperature.value = stream_filter_update(&temp_filter, temperature);
+    agg->humidity.value = stream_filter_update(&humid_filter, humidity);
+    stream_stats_add(&temp_stats, temperature);
+    stream_stats_add(&humid_stats, humidity);
+    
+    if (temp_stats.count < CONFIG_APP_OVERSAMPLE_WINDOW) {
+        return false;
+    }
+    
+    agg->timestamp_us = sample->timestamp_us;
+    agg->count = temp_stats.count;
+    close_channel(&agg->temperature, &temp_stats);
+    close_channel(&agg->humidity, &humid_stats);
+    
+    return true;
+}
+#endif
+
+// Function to send a status message via UART (text mode only, so it
+// can't break up the binary frame stream)
+void send_uart_message(const char *msg)
+{
+    if (!atomic_get(&app_cfg.binary)) {
+        serial_tx_puts(msg);
+    }
+}
+
+// Function to print UART TX ring statistics
+void print_uart_stats(void)
+{
+    struct serial_tx_stats stats;
+    
+    serial_tx_get_stats(&stats);
+    printk("UART TX: %u bytes sent, %u overflow(s) (%u bytes dropped), high water %u/%d\n",
+           stats.bytes_sent, stats.overflows, stats.bytes_dropped,
+           stats.high_water, CONFIG_SERIAL_TX_BUF_SIZE);
+}
+
+// Function to read a raw, timestamped sample from AHT10
+int aht10_read_data(struct telemetry_sample *sample)
+{
+    struct aht10_sample raw;
+    uint32_t fetch_start;
+    int ret;
+    
+    // The driver triggers the measurement and sleeps until its state
+    // machine signals completion; the bus is free during the conversion.
+    // A hung sensor ends at the driver's busy deadline, a faulted one is
+    // re-initialized first or, while backing off, fails right away.
+    fetch_start = k_cycle_get_32();
+    LATENCY_START(start);
+    ret = sensor_sample_fetch(aht10_dev);
+    LATENCY_END(app_sample_fetch, start);
+    sample_max_us = MAX(sample_max_us, k_cyc_to_us_floor32(k_cycle_get_32() - fetch_start));
+    if (ret != 0) {
+        return ret;
+    }
+    
+    // Keep the raw 20-bit readings; conversion is integer-only. The
+    // timestamp is the driver's: when the conversion was seen complete.
+    aht10_get_raw(aht10_dev, &raw);
+    sample->timestamp_us = raw.timestamp_us;
+    sample->raw_humidity = raw.raw_humidity;
+    sample->raw_temperature = raw.raw_temperature;
+    
+    return 0;
+}
+
+// Function to scan I2C bus
+void scan_i2c_bus(void)
+{
+    struct i2c_scan_result result;
+    
+    printk("Starting I2C bus scan...\n");
+    printk("Scanning addresses 0x08 to 0x77\n");
+    
+    // Back-to-back zero-length probes into a bitmap; the table is printed
+    // once at the end so console output doesn't slow the scan down
+    if (i2c_scan_bus(i2c_dev, &result) != 0) {
+        printk("ERROR: I2C bus scan failed\n");
+        return;
+    }
+    
+    i2c_scan_print(&result);
+}
+
+#ifdef CONFIG_I2C_SPEED
+// Function to run the sensor bus at the fastest speed the sensor still
+// reads back cleanly at (the devicetree speed is only the boot default)
+void negotiate_bus_speed(void)
+{
+    const struct i2c_speed_target target = {
+        .addr = DT_REG_ADDR(AHT10_NODE),
+        .check_len = 6,     // Status byte + 20-bit humidity and temperature
+    };
+    struct i2c_speed_result result;
+    int ret;
+    
+    ret = i2c_speed_negotiate(i2c_dev, CONFIG_APP_I2C_MAX_SPEED, &target, 1, &result);
+    if (ret != 0) {
+        printk("WARNING: %s fails even at %u Hz (error: %d)\n",
+               i2c_dev->name, result.bitrate, ret);
+        return;
+    }
+    
+    printk("I2C: %s at %u Hz (%u speed(s) tried, %u fallback(s))\n",
+           i2c_dev->name, result.bitrate, result.tried, result.fallbacks);
+}
+#endif
+
+// Function to decide whether a reading goes out on the console and UART
+// (the LEDs always follow the latest reading)
+bool should_report(int32_t temperature, int32_t humidity, uint64_t timestamp_us)
+{
+#ifdef CONFIG_DEADBAND_REPORT
+    return deadband_check(&report_gate, temperature, humidity,
+                          timestamp_us / USEC_PER_MSEC);
+#else
+    ARG_UNUSED(temperature);
+    ARG_UNUSED(humidity);
+    ARG_UNUSED(timestamp_us);
+    return true;
+#endif
+}
+
+// Function to print how many readings report-on-change held back
+void print_report_stats(void)
+{
+#ifdef CONFIG_DEADBAND_REPORT
+    printk("Reports: %u sent, %u suppressed (%u heartbeat(s))\n",
+           report_gate.stats.sent, report_gate.stats.suppressed,
+           report_gate.stats.heartbeats);
+#endif
+}
+
+#ifdef CONFIG_APP_SAMPLE_LOG
+// Function to handle a byte from the host (UART ISR context)
+void uart_rx_handler(uint8_t c, void *user_data)
+{
+    ARG_UNUSED(user_data);
+    
+    if (c == LOG_DRAIN_COMMAND) {
+        atomic_set(&drain_requested, 1);
+        // Wakes the observers without a new record; the UART one drains
+        zbus_chan_notify(&sample_chan, K_NO_WAIT);
+    }
+}
+
+// Function to send one logged sample. Replayed samples have their own
+// frame type and sequence (binary) or a "log" field (text), so the host
+// can tell them from live ones and the live sequence has no gaps. The
+// timestamp counts from boot @p boot.
+void send_uart_log_sample(const struct telemetry_sample *sample, uint32_t boot, uint16_t seq)
+{
+    char uart_buffer[128];
+    char temp_str[FIXEDPOINT_CENTI_STR_LEN];
+    char humid_str[FIXEDPOINT_CENTI_STR_LEN];
+    unsigned long long timestamp_us = sample->timestamp_us;
+    int len;
+    
+#ifdef CONFIG_TELEMETRY_FRAME
+    if (atomic_get(&app_cfg.binary)) {
+        uint8_t frame[TELEMETRY_FRAME_MAX_LEN];
+        
+        serial_tx_write(frame, telemetry_encode_log_sample(sample, boot, seq, frame));
+        return;
+    }
+#endif
+    
+    fixedpoint_centi_to_str(aht10_raw_to_centi_celsius(sample->raw_temperature), temp_str);
+    fixedpoint_centi_to_str(aht10_raw_to_centi_percent(sample->raw_humidity), humid_str);
+    len = snprintf(uart_buffer, sizeof(uart_buffer),
+                   "{\"log\":%u,\"boot\":%u,\"temperature\":%s,\"humidity\":%s,"
+                   "\"timestamp_us\":%llu}\r\n",
+                   seq, boot, temp_str, humid_str, timestamp_us);
+    serial_tx_write(uart_buffer, len);
+}
+
+// Function to send one logged sample, waiting for ring space instead of
+// dropping so the replay runs at full link speed. Called without the
+// log's lock held, so the store observer keeps appending meanwhile.
+int replay_sample(const struct telemetry_sample *sample, uint32_t boot, void *user_data)
+{
+    uint16_t *seq = user_data;
+    
+    while (CONFIG_SERIAL_TX_BUF_SIZE - serial_tx_pending() < 128) {
+        k_msleep(1);
+    }
+    send_uart_log_sample(sample, boot, (*seq)++);
+    
+    return 0;
+}
+
+// Function to replay the flash log to the host and clear it
+void drain_log(void)
+{
+    static uint16_t seq;
+    int64_t start = k_uptime_get();
+    int ret;
+    
+    send_uart_message("LOG BEGIN\r\n");
+    ret = sample_log_drain(replay_sample, &seq);
+    send_uart_message("LOG END\r\n");
+    
+    if (ret < 0) {
+        printk("ERROR: Log drain failed (error: %d)\n", ret);
+        return;
+    }
+    
+    printk("Log: drained %d record(s) in %lld ms\n", ret, k_uptime_get() - start);
+}
+
+// Function to print sample log statistics
+void print_log_stats(void)
+{
+    struct sample_log_stats stats;
+    uint32_t centi_bytes, rate;
+    
+    sample_log_get_stats(&stats);
+    if (stats.appended == 0) {
+        return;
+    }
+    
+    centi_bytes = (uint32_t)((uint64_t)stats.bytes * 100 / stats.appended);
+    rate = (stats.append_us > 0) ?
+        (uint32_t)((uint64_t)stats.appended * 1000000 / stats.append_us) : 0;
+    printk("Log: %u record(s), %u chunk(s), %u.%02u bytes/record, %u records/s, %u rotation(s)\n",
+           stats.appended, stats.chunks, centi_bytes / 100, centi_bytes % 100, rate,
+           stats.rotations);
+}
+#endif
+
+#ifdef CONFIG_APP_LOW_POWER
+// Function to put a device under runtime PM; it stays suspended until
+// power_get(). Devices without PM support just stay on.
+void power_init(struct power_domain *pd, const struct device *dev)
+{
+    int ret;
+    
+    pd->dev = dev;
+    ret = pm_device_runtime_enable(dev);
+    pd->managed = (ret == 0);
+    
+    if (ret != 0) {
+        printk("%s: no runtime PM (error: %d), stays on\n", pd->name, ret);
+    }
+}
+
+// Function to resume a device for use
+void power_get(struct power_domain *pd)
+{
+    k_spinlock_key_t key;
+    
+    if (!pd->managed || pm_device_runtime_get(pd->dev) != 0) {
+        return;
+    }
+    
+    key = k_spin_lock(&pd->lock);
+    if (pd->users++ == 0) {
+        pd->resumes++;
+        pd->on_since = k_uptime_get();
+    }
+    k_spin_unlock(&pd->lock, key);
+}
+
+// Function to let a device suspend again
+void power_put(struct power_domain *pd)
+{
+    k_spinlock_key_t key;
+    
+    if (!pd->managed) {
+        return;
+    }
+    
+    key = k_spin_lock(&pd->lock);
+    if (pd->users > 0 && --pd->users == 0) {
+        pd->on_ms += k_uptime_get() - pd->on_since;
+    }
+    k_spin_unlock(&pd->lock, key);
+    
+    pm_device_runtime_put(pd->dev);
+}
+#endif
+
+#ifdef CONFIG_APP_POWER_STATS
+#ifdef CONFIG_APP_LOW_POWER
+// Function to print how long a device was resumed
+void print_power_domain(const struct power_domain *pd)
+{
+    uint32_t on = (uint32_t)(pd->on_ms * 10000 / MAX(k_uptime_get(), 1));
+    
+    if (pd->managed) {
+        printk("Power: %s %u resume(s), on %lld ms (%u.%02u%%)\n",
+               pd->name, pd->resumes, pd->on_ms, on / 100, on % 100);
+    }
+}
+#endif
+
+// Function to print CPU duty cycle, wakeups and device time-in-state
+void print_power_stats(void)
+{
+    k_thread_runtime_stats_t cpu;
+    uint32_t busy = 0;
+    
+    // execution_cycles counts everything, total_cycles everything but idle
+    k_thread_runtime_stats_all_get(&cpu);
+    if (cpu.execution_cycles > 0) {
+        busy = (uint32_t)(cpu.total_cycles * 10000 / cpu.execution_cycles);
+    }
+    
+    printk("Power: CPU %u.%02u%% busy, wakeups: %d acquisition, %d output\n",
+           busy / 100, busy % 100, (int)atomic_get(&acq_wakeups),
+           (int)atomic_get(&output_wakeups));
+    
+#ifdef CONFIG_APP_LOW_POWER
+    // The I2C figures are updated from the acquisition thread
+    print_power_domain(&i2c_power);
+    print_power_domain(&uart_power);
+#endif
+}
+#endif
+
+#ifdef CONFIG_APP_BENCHMARK
+// Function to report the benchmark figures in machine-readable form
+void report_benchmark(uint32_t samples)
+{
+    struct serial_tx_stats stats;
+    struct sample_clock_stats sched;
+    uint32_t bytes;
+    
+    serial_tx_get_stats(&stats);
+    bytes = stats.bytes_sent + serial_tx_pending() - bench_bytes_start;
+    sample_clock_get_stats(&acq_clock, &sched);
+    
+    bench_report("led.init_us", bench_ready_us);
+    bench_report("led.first_sample_us", first_sample_us);
+    bench_report("led.acq_max_us", bench_acq_max_us);
+    bench_report("led.output_avg_us", bench_output_total_us / samples);
+    bench_report("led.output_max_us", bench_output_max_us);
+    bench_report("led.uart_bytes_per_sample", bytes / samples);
+    bench_report("led.log_bytes_per_sample", bench_log_bytes / samples);
+    bench_report("led.sample_lag_us", sched.lag_mean_us);
+    bench_report("led.sample_jitter_us", sched.jitter_us);
+    
+    // Worst delay from publication to each observer being done
+    for (size_t i = 0; i < ARRAY_SIZE(observers); i++) {
+        char metric[40];
+        
+        snprintk(metric, sizeof(metric), "led.%s_latency_max_us", observers[i]->name);
+        bench_report(metric, observers[i]->latency_max_us);
+    }
+    printk("Benchmark complete\n");
+}
+#endif
+
+// Function to get the backlog of the slowest observer
+uint32_t ring_backlog(void)
+{
+    uint32_t head = atomic_get(&sample_head);
+    uint32_t backlog = 0;
+    
+    for (size_t i = 0; i < ARRAY_SIZE(observers); i++) {
+        backlog = MAX(backlog, head - observers[i]->cursor);
+    }
+    
+    return MIN(backlog, CONFIG_APP_SAMPLE_QUEUE_SIZE);
+}
+
+// Function to print sample ring statistics: the slowest observer's
+// backlog, and the records any observer lost to overruns
+void print_queue_stats(void)
+{
+    uint32_t dropped = 0;
+    
+    for (size_t i = 0; i < ARRAY_SIZE(observers); i++) {
+        dropped += observers[i]->overruns;
+    }
+    
+    printk("Queue: %u/%d used, high water %d, %u dropped, %u pinned\n", ring_backlog(),
+           CONFIG_APP_SAMPLE_QUEUE_SIZE, (int)atomic_get(&queue_high_water), dropped,
+           pinned_drops);
+}
+
+// Function to print each observer's share of the work: records handled
+// and lost, and the delay from a notice to its records being handled
+void print_observer_stats(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(observers); i++) {
+        const struct sample_observer *obs = observers[i];
+        uint32_t mean_us = (obs->batches > 0) ? obs->latency_total_us / obs->batches : 0;
+        
+        printk("Observer %s: %u handled, %u overrun(s), latency mean %u / max %u us\n",
+               obs->name, obs->handled, obs->overruns, mean_us, obs->latency_max_us);
+    }
+    printk("Notices: %d published, %d undelivered\n", (int)atomic_get(&output_wakeups),
+           (int)atomic_get(&notice_failures));
+}
 
-// GPIO LED specifications
-static struct gpio_dt_spec red_led = GPIO_DT_SPEC_GET(LED_RED_NODE, gpios);
-static struct gpio_dt_spec green_led = GPIO_DT_SPEC_GET(LED_GREEN_NODE, gpios);
-static struct gpio_dt_spec blue_led = GPIO_DT_SPEC_GET(LED_BLUE_NODE, gpios);
+// Function to print the sensor's fault and recovery counters and the
+// slowest read seen: the bound on sample latency, faults included
+void print_fault_stats(void)
+{
+    struct aht10_fault_stats faults;
+    
+    aht10_get_fault_stats(aht10_dev, &faults);
+    printk("Faults: %u timeout(s), %u bus error(s), %u bus recovery(ies), "
+           "%u re-init(s) (%u failed), worst sample %u us, %u CRC error(s)\n",
+           faults.timeouts, faults.bus_errors, faults.bus_recoveries,
+           faults.reinits, faults.reinit_failures, sample_max_us, faults.crc_errors);
+}
 
-// Function to initialize GPIO LEDs
-int init_leds(void)
+// Function to print how closely samples keep to the acquisition schedule:
+// lag is from a tick to the sample's conversion completing
+void print_schedule_stats(void)
 {
-    int ret;
+    struct sample_clock_stats stats;
     
-    printk("Initializing LEDs...\n");
+    sample_clock_get_stats(&acq_clock, &stats);
+    printk("Schedule: %u tick(s), %u missed, lag min %u / mean %u / max %u us, "
+           "jitter %u us\n", stats.ticks, stats.missed, stats.lag_min_us,
+           stats.lag_mean_us, stats.lag_max_us, stats.jitter_us);
+}
+
+// Function to wait for the next tick of the schedule, or the first one of
+// a period the shell just set. The watchdog is fed along the way, so
+// periods longer than its timeout (up to an hour) still work.
+void wait_tick(void)
+{
+#ifdef CONFIG_APP_WATCHDOG
+    while (sample_clock_wait(&acq_clock, K_MSEC(CONFIG_APP_WATCHDOG_TIMEOUT_MS / 2)) != 0) {
+        task_wdt_feed(acq_wdt_channel);
+    }
+#else
+    sample_clock_wait(&acq_clock, K_FOREVER);
+#endif
+}
+
+// Function to write a reading to the ring and, once per batch or right
+// away for an error, tell the observers. Never waits for an observer: a
+// full notice queue just means that observer is already behind, and a
+// slot an observer still has pinned costs this reading instead.
+void publish_record(const struct telemetry_sample *sample,
+                    const struct telemetry_aggregate *agg, int err)
+{
+    uint32_t seq = atomic_get(&sample_head);
+    struct sample_record *rec = &sample_ring[seq % CONFIG_APP_SAMPLE_QUEUE_SIZE];
+    atomic_val_t old_seq = atomic_set(&rec->seq, -1);
+    struct sample_notice notice;
+    uint32_t backlog;
     
-    // Configure red LED
-    if (!gpio_is_ready_dt(&red_led)) {
-        printk("ERROR: Red LED GPIO device not ready\n");
-        return -1;
+    // Invalidated first, so an observer pinning it from now on backs off;
+    // one that pinned it before is still handling it
+    if (atomic_get(&rec->readers) != 0) {
+        atomic_set(&rec->seq, old_seq);
+        pinned_drops++;
+        return;
     }
-    ret = gpio_pin_configure_dt(&red_led, GPIO_OUTPUT_INACTIVE);
-    if (ret < 0) {
-        printk("ERROR: Failed to configure red LED GPIO\n");
-        return ret;
+    
+    rec->sample = *sample;
+#ifdef CONFIG_APP_OVERSAMPLE
+    rec->agg = *agg;
+#endif
+    rec->err = err;
+    
+    // Decided once here so the console and UART report the same readings
+    if (err != 0) {
+        rec->report = false;
+    } else if (IS_ENABLED(CONFIG_APP_OVERSAMPLE)) {
+        rec->report = should_report(agg->temperature.value, agg->humidity.value,
+                                    sample->timestamp_us);
+    } else {
+        rec->report = should_report(aht10_raw_to_centi_celsius(sample->raw_temperature),
+                                    aht10_raw_to_centi_percent(sample->raw_humidity),
+                                    sample->timestamp_us);
     }
     
-    // Configure green LED
-    if (!gpio_is_ready_dt(&green_led)) {
-        printk("ERROR: Green LED GPIO device not ready\n");
-        return -1;
+    atomic_set(&rec->seq, seq);
+    atomic_set(&sample_head, seq + 1);
+    
+    // Only this thread writes the high-water mark
+    backlog = ring_backlog();
+    if (backlog > atomic_get(&queue_high_water)) {
+        atomic_set(&queue_high_water, backlog);
     }
-    ret = gpio_pin_configure_dt(&green_led, GPIO_OUTPUT_INACTIVE);
-    if (ret < 0) {
-        printk("ERROR: Failed to configure green LED GPIO\n");
-        return ret;
+    
+    if (backlog < CONFIG_APP_OUTPUT_BATCH && err == 0) {
+        return;
     }
     
-    // Configure blue LED
-    if (!gpio_is_ready_dt(&blue_led)) {
-        printk("ERROR: Blue LED GPIO device not ready\n");
-        return -1;
+    notice.head = seq + 1;
+    notice.cycles = k_cycle_get_32();
+    if (zbus_chan_pub(&sample_chan, &notice, K_NO_WAIT) != 0) {
+        atomic_inc(&notice_failures);
     }
-    ret = gpio_pin_configure_dt(&blue_led, GPIO_OUTPUT_INACTIVE);
-    if (ret < 0) {
-        printk("ERROR: Failed to configure blue LED GPIO\n");
-        return ret;
+    atomic_inc(&output_wakeups);
+}
+
+// High-priority thread: read the sensor and publish the sample, nothing else
+void acq_thread_entry(void *p1, void *p2, void *p3)
+{
+    struct telemetry_sample sample;
+    struct telemetry_aggregate agg = {0};
+    int ret;
+    
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    
+#ifdef CONFIG_APP_OVERSAMPLE
+    stream_filter_init(&temp_filter, OVERSAMPLE_FILTER, OVERSAMPLE_FILTER_PARAM);
+    stream_filter_init(&humid_filter, OVERSAMPLE_FILTER, OVERSAMPLE_FILTER_PARAM);
+    stream_stats_reset(&temp_stats);
+    stream_stats_reset(&humid_stats);
+#endif
+    
+    while (1) {
+        // Readings start on the schedule's ticks, however long the last
+        // one took (oversampling runs conversions back to back)
+        if (!IS_ENABLED(CONFIG_APP_OVERSAMPLE)) {
+            wait_tick();
+        }
+        atomic_inc(&acq_wakeups);
+#ifdef CONFIG_APP_WATCHDOG
+        task_wdt_feed(acq_wdt_channel);
+#endif
+#ifdef CONFIG_APP_BENCHMARK
+        uint32_t loop_start = k_cycle_get_32();
+#endif
+        
+        k_mutex_lock(&bus_lock, K_FOREVER);
+#ifdef CONFIG_APP_LOW_POWER
+        // The bus is only powered for the measurement itself
+        power_get(&i2c_power);
+        ret = aht10_read_data(&sample);
+        power_put(&i2c_power);
+#else
+        ret = aht10_read_data(&sample);
+#endif
+        k_mutex_unlock(&bus_lock);
+        
+        if (ret == 0 && !IS_ENABLED(CONFIG_APP_OVERSAMPLE)) {
+            sample_clock_record(&acq_clock, sample.timestamp_us);
+        }
+        
+        if (ret == 0 && first_sample_us == 0) {
+            first_sample_us = MAX(sample.timestamp_us, 1);
+            k_work_submit_to_queue(&boot_workq, &boot_work);
+        }
+        
+#ifdef CONFIG_APP_OVERSAMPLE
+        // Back-to-back conversions; only a finished window is published
+        if (ret == 0 && !oversample_add(&sample, &agg)) {
+            continue;
+        }
+#endif
+        
+        publish_record(&sample, &agg, ret);
+        
+#ifdef CONFIG_APP_BENCHMARK
+        // Worst iteration: measurement plus publishing, without the wait
+        bench_acq_max_us = MAX(bench_acq_max_us,
+                               k_cyc_to_us_floor32(k_cycle_get_32() - loop_start));
+#endif
+        
+        // Oversampling backs off after an error: skip the ticks that
+        // passed while converting, then wait for the next one
+        if (IS_ENABLED(CONFIG_APP_OVERSAMPLE) && ret != 0) {
+            while (sample_clock_wait(&acq_clock, K_NO_WAIT) == 0) {
+            }
+            wait_tick();
+        }
     }
+}
+
+// Function to wait for the next notice for @obs and get when it was
+// published (k_cycle_get_32())
+int observer_wait(struct sample_observer *obs, uint32_t *published)
+{
+    const struct zbus_channel *chan;
+    struct sample_notice notice;
+    int ret;
     
-    printk("LEDs initialized successfully\n");
-    return 0;
+    ret = zbus_sub_wait(obs->sub, &chan, K_FOREVER);
+    if (ret == 0) {
+        ret = zbus_chan_read(chan, &notice, K_FOREVER);
+        *published = notice.cycles;
+    }
+    
+    return ret;
 }
 
-// Function to control LEDs based on temperature and humidity
-void control_leds(float temperature, float humidity)
+// Function to pin the next record for @obs in the ring, NULL once the
+// observer has caught up. A record the acquisition thread reused, or is
+// rewriting, is skipped and counted as an overrun. Release the record
+// with observer_release() once handled.
+struct sample_record *observer_next(struct sample_observer *obs)
 {
-    // Turn off all LEDs first
-    gpio_pin_set_dt(&red_led, 0);
-    gpio_pin_set_dt(&green_led, 0);
-    gpio_pin_set_dt(&blue_led, 0);
+    uint32_t head = atomic_get(&sample_head);
+    struct sample_record *slot;
     
-    // Control LEDs based on sensor readings
-    if (temperature > TEMP_HIGH_THRESHOLD) {
-        gpio_pin_set_dt(&red_led, 1);  // Red LED for high temperature
-        printk("LED Status: RED (High Temperature)\n");
-    } else if (temperature < TEMP_LOW_THRESHOLD) {
-        gpio_pin_set_dt(&blue_led, 1); // Blue LED for low temperature
-        printk("LED Status: BLUE (Low Temperature)\n");
+    for (; obs->cursor != head; obs->cursor++) {
+        slot = &sample_ring[obs->cursor % CONFIG_APP_SAMPLE_QUEUE_SIZE];
+        
+        // Pinned before the check: from here on the slot isn't rewritten
+        // unless the check fails
+        atomic_inc(&slot->readers);
+        if ((uint32_t)atomic_get(&slot->seq) == obs->cursor) {
+            obs->cursor++;
+            return slot;
+        }
+        atomic_dec(&slot->readers);
+        obs->overruns++;
     }
     
-    if (humidity > HUMIDITY_HIGH_THRESHOLD) {
-        gpio_pin_set_dt(&green_led, 1); // Green LED for high humidity
-        printk("LED Status: GREEN (High Humidity)\n");
+    return NULL;
+}
+
+// Function to unpin a record from observer_next()
+void observer_release(struct sample_record *rec)
+{
+    atomic_dec(&rec->readers);
+}
+
+// Function to hand every record published since the last call to the
+// observer's handler, and account the latency since @published
+void observer_drain(struct sample_observer *obs, uint32_t published)
+{
+    struct sample_record *rec;
+    uint32_t count = 0;
+    uint32_t latency_us;
+    
+    while ((rec = observer_next(obs)) != NULL) {
+        obs->handle(rec);
+        observer_release(rec);
+        obs->handled++;
+        count++;
     }
     
-    // If no conditions met, all LEDs remain off
-    if (temperature >= TEMP_LOW_THRESHOLD && temperature <= TEMP_HIGH_THRESHOLD && 
-        humidity <= HUMIDITY_HIGH_THRESHOLD) {
-        printk("LED Status: All OFF (Normal conditions)\n");
+    if (count > 0) {
+        latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - published);
+        obs->latency_max_us = MAX(obs->latency_max_us, latency_us);
+        obs->latency_total_us += latency_us;
+        obs->batches++;
     }
 }
 
-// Function to send data via UART
-void send_uart_data(float temperature, float humidity)
+// Observer thread: wait for notices and handle their records (@p1 is the
+// struct sample_observer)
+void observer_thread_entry(void *p1, void *p2, void *p3)
 {
-    char uart_buffer[128];
-    int len;
+    struct sample_observer *obs = p1;
+    uint32_t published;
     
-    // Format the data as JSON for easier parsing
-    len = snprintf(uart_buffer, sizeof(uart_buffer),
-                   "{\"temperature\":%.2f,\"humidity\":%.2f,\"timestamp\":%lld}\r\n",
-                   temperature, humidity, k_uptime_get());
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
     
-    // Send via UART
-    for (int i = 0; i < len; i++) {
-        uart_poll_out(uart_dev, uart_buffer[i]);
+    while (observer_wait(obs, &published) == 0) {
+        observer_drain(obs, published);
     }
+}
+
+// LED observer: the LEDs follow every reading, reported or not
+void led_record(const struct sample_record *rec)
+{
+    int32_t temperature, humidity;
     
-    // Also send human-readable format
-    len = snprintf(uart_buffer, sizeof(uart_buffer),
-                   "TEMP: %.2f°C, HUMID: %.2f%%, TIME: %lldms\r\n",
-                   temperature, humidity, k_uptime_get());
+    if (rec->err != 0) {
+        return;
+    }
+    
+#ifdef CONFIG_APP_OVERSAMPLE
+    // Filtered values drive the LEDs
+    temperature = rec->agg.temperature.value;
+    humidity = rec->agg.humidity.value;
+#else
+    LATENCY_START(convert_start);
+    temperature = aht10_raw_to_centi_celsius(rec->sample.raw_temperature);
+    humidity = aht10_raw_to_centi_percent(rec->sample.raw_humidity);
+    LATENCY_END(app_convert, convert_start);
+#endif
+    
+    k_mutex_lock(&led_lock, K_FOREVER);
+    control_leds(temperature, humidity);
+    k_mutex_unlock(&led_lock);
+}
+
+// Console observer: reported readings and read errors as log messages
+void console_record(const struct sample_record *rec)
+{
+#ifdef CONFIG_APP_BENCHMARK
+    uint32_t record_log = bench_log_pending();
+#endif
     
-    for (int i = 0; i < len; i++) {
-        uart_poll_out(uart_dev, uart_buffer[i]);
+    if (rec->err != 0) {
+        LOG_ERR("Failed to read AHT10 data (error: %d)", rec->err);
+    } else if (rec->report) {
+#ifdef CONFIG_APP_OVERSAMPLE
+        print_channel("Temperature", "°C", &rec->agg.temperature);
+        print_channel("Humidity", "%", &rec->agg.humidity);
+        LOG_INF("Window: %u samples", rec->agg.count);
+#else
+        int32_t temperature = aht10_raw_to_centi_celsius(rec->sample.raw_temperature);
+        int32_t humidity = aht10_raw_to_centi_percent(rec->sample.raw_humidity);
+        
+        // Deferred: formatted by the log thread, not here
+        LOG_INF("Temperature: " FIXEDPOINT_CENTI_FMT "°C, Humidity: "
+                FIXEDPOINT_CENTI_FMT "%%", FIXEDPOINT_CENTI_ARGS(temperature),
+                FIXEDPOINT_CENTI_ARGS(humidity));
+#endif
     }
+    
+#ifdef CONFIG_APP_BENCHMARK
+    bench_log_bytes += bench_log_pending() - record_log;
+#endif
 }
 
-// Function to initialize AHT10 sensor
-int aht10_init(void)
+#ifdef CONFIG_APP_SAMPLE_LOG
+// Store observer: everything goes to flash, whether or not the host is
+// listening
+void store_record(const struct sample_record *rec)
 {
-    uint8_t init_cmd[3] = {AHT10_CMD_INIT, 0x08, 0x00};
-    uint8_t status;
-    int ret;
+    static uint32_t logged;
     
-    printk("Initializing AHT10 sensor...\n");
+    if (rec->err != 0) {
+        return;
+    }
     
-    // Send soft reset command first
-    uint8_t reset_cmd = AHT10_CMD_SOFT_RESET;
-    ret = i2c_write(i2c_dev, &reset_cmd, 1, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to send reset command to AHT10\n");
-        return ret;
+    sample_log_append(&rec->sample);
+    
+    // The UART observer drains once it is done with this batch
+    if (CONFIG_APP_SAMPLE_LOG_DRAIN_INTERVAL > 0 &&
+        ++logged >= CONFIG_APP_SAMPLE_LOG_DRAIN_INTERVAL) {
+        atomic_set(&drain_requested, 1);
+        logged = 0;
     }
+}
+#endif
+
+// UART observer: reported readings and errors on the data UART, plus the
+// periodic statistics on the console
+void uart_record(const struct sample_record *rec)
+{
+    static uint32_t samples;
+#ifdef CONFIG_APP_BENCHMARK
+    uint32_t record_start = k_cycle_get_32();
+#endif
     
-    // Wait for reset to complete
-    k_msleep(20);
+    if (rec->err != 0) {
+        // Send error via UART
+        send_uart_message("ERROR: Sensor read failed\r\n");
+    } else if (rec->report) {
+#ifdef CONFIG_APP_OVERSAMPLE
+        send_uart_aggregate(&rec->agg);
+#else
+        send_uart_data(&rec->sample);
+#endif
+    }
     
-    // Send initialization command
-    ret = i2c_write(i2c_dev, init_cmd, 3, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to initialize AHT10\n");
-        return ret;
+#ifdef CONFIG_APP_BENCHMARK
+    uint32_t record_us = k_cyc_to_us_floor32(k_cycle_get_32() - record_start);
+    
+    bench_output_max_us = MAX(bench_output_max_us, record_us);
+    bench_output_total_us += record_us;
+    if (samples + 1 == CONFIG_APP_BENCHMARK_SAMPLES) {
+        report_benchmark(samples + 1);
     }
+#endif
     
-    // Wait for initialization
-    k_msleep(10);
+    if (++samples % UART_STATS_INTERVAL == 0) {
+        print_uart_stats();
+        print_queue_stats();
+        print_observer_stats();
+        print_led_stats();
+        print_fault_stats();
+        if (!IS_ENABLED(CONFIG_APP_OVERSAMPLE)) {
+            print_schedule_stats();
+        }
+        print_report_stats();
+#ifdef CONFIG_APP_POWER_STATS
+        print_power_stats();
+#endif
+#ifdef CONFIG_APP_SAMPLE_LOG
+        print_log_stats();
+#endif
+    }
+}
+
+// UART observer thread: like the others, plus powering the UART for one
+// batch at a time and replaying the flash log when asked to
+void uart_thread_entry(void *p1, void *p2, void *p3)
+{
+    uint32_t published;
     
-    // Check if sensor is calibrated
-    ret = i2c_read(i2c_dev, &status, 1, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to read AHT10 status\n");
-        return ret;
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    
+    while (observer_wait(&uart_obs, &published) == 0) {
+#ifdef CONFIG_APP_LOW_POWER
+        // The UART is awake for one batch at a time
+        power_get(&uart_power);
+#ifdef CONFIG_APP_SAMPLE_LOG
+        // A resume reconfigures the UART, RX interrupt included
+        serial_tx_set_rx_callback(uart_rx_handler, NULL);
+#endif
+#endif
+        
+        observer_drain(&uart_obs, published);
+        
+#ifdef CONFIG_APP_SAMPLE_LOG
+        if (atomic_get(&log_ready) && atomic_cas(&drain_requested, 1, 0)) {
+            drain_log();
+        }
+#endif
+        
+#ifdef CONFIG_APP_LOW_POWER
+        // Let the ring drain before the clock goes away
+        serial_tx_flush(K_SECONDS(1));
+        power_put(&uart_power);
+#endif
+    }
+}
+
+// Function to look up a runtime parameter by name
+const struct app_param *app_param_find(const char *name)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(app_params); i++) {
+        if (strcmp(app_params[i].name, name) == 0) {
+            return &app_params[i];
+        }
     }
     
-    if (!(status & AHT10_STATUS_CALIBRATED)) {
-        printk("ERROR: AHT10 not calibrated (status: 0x%02X)\n", status);
-        return -1;
+    return NULL;
+}
+
+// Function to apply a parameter and persist it. The threads see the new
+// value on their next load; the flash write happens in the caller's
+// (shell) thread, after the value is already live.
+int app_param_set(const struct app_param *param, int32_t value)
+{
+    if (value < param->min || value > param->max) {
+        return -EINVAL;
+    }
+    
+    atomic_set(param->value, value);
+    if (param->value == &app_cfg.period_ms) {
+        sample_clock_set_period(&acq_clock, value);
     }
     
-    printk("AHT10 initialized successfully (status: 0x%02X)\n", status);
+#ifdef CONFIG_SETTINGS
+    char key[32];
+    
+    snprintf(key, sizeof(key), "app/%s", param->name);
+    return settings_save_one(key, &value, sizeof(value));
+#else
     return 0;
+#endif
 }
 
-// Function to read temperature and humidity from AHT10
-int aht10_read_data(float *temperature, float *humidity)
+#ifdef CONFIG_SETTINGS
+// Function to restore one saved parameter while the settings are loaded
+int app_settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
 {
-    uint8_t trigger_cmd[3] = {AHT10_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t data[6];
-    uint32_t raw_humidity, raw_temperature;
+    const struct app_param *param = app_param_find(name);
+    int32_t value;
     int ret;
     
-    // Send measurement trigger command
-    ret = i2c_write(i2c_dev, trigger_cmd, 3, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to trigger AHT10 measurement\n");
+    if (param == NULL || len != sizeof(value)) {
+        return -ENOENT;
+    }
+    
+    ret = read_cb(cb_arg, &value, sizeof(value));
+    if (ret < 0) {
         return ret;
     }
     
-    // Wait for measurement to complete (typical 75ms)
-    k_msleep(80);
+    // Ranges may have tightened since the value was saved
+    if (value < param->min || value > param->max) {
+        return -EINVAL;
+    }
     
-    // Check if measurement is ready
-    do {
-        ret = i2c_read(i2c_dev, data, 1, AHT10_I2C_ADDR);
-        if (ret != 0) {
-            printk("ERROR: Failed to read AHT10 status\n");
-            return ret;
-        }
-        
-        if (data[0] & AHT10_STATUS_BUSY) {
-            k_msleep(10);  // Wait a bit more if still busy
-        }
-    } while (data[0] & AHT10_STATUS_BUSY);
+    atomic_set(param->value, value);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(app, "app", NULL, app_settings_set, NULL, NULL);
+#endif
+
+#ifdef CONFIG_SHELL
+// Function to report the result of a parameter change on the shell
+int shell_param_set(const struct shell *sh, const char *name, int32_t value)
+{
+    int ret = app_param_set(app_param_find(name), value);
     
-    // Read the full 6-byte data
-    ret = i2c_read(i2c_dev, data, 6, AHT10_I2C_ADDR);
-    if (ret != 0) {
-        printk("ERROR: Failed to read AHT10 data\n");
-        return ret;
+    if (ret == -EINVAL) {
+        shell_error(sh, "%s out of range", name);
+    } else if (ret != 0) {
+        // Already applied, just not saved
+        shell_warn(sh, "%s applied but not saved (error: %d)", name, ret);
     }
     
-    // Extract raw humidity (20-bit, bits 19:0 of data[1:3])
-    raw_humidity = ((uint32_t)data[1] << 12) | 
-                   ((uint32_t)data[2] << 4) | 
-                   ((uint32_t)data[3] >> 4);
+    return ret == -EINVAL ? ret : 0;
+}
+
+// aht10 show
+int cmd_show(const struct shell *sh, size_t argc, char **argv)
+{
+    char str[3][FIXEDPOINT_CENTI_STR_LEN];
+    
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
     
-    // Extract raw temperature (20-bit, bits 19:0 of data[3:5])
-    raw_temperature = (((uint32_t)data[3] & 0x0F) << 16) | 
-                      ((uint32_t)data[4] << 8) | 
-                      (uint32_t)data[5];
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_low), str[0]);
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_high), str[1]);
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.humidity_high), str[2]);
     
-    // Convert to actual values
-    *humidity = ((float)raw_humidity / 1048576.0f) * 100.0f;
-    *temperature = (((float)raw_temperature / 1048576.0f) * 200.0f) - 50.0f;
+    shell_print(sh, "period:    %d ms", (int)atomic_get(&app_cfg.period_ms));
+    shell_print(sh, "temp_low:  %s C", str[0]);
+    shell_print(sh, "temp_high: %s C", str[1]);
+    shell_print(sh, "humidity:  %s %%", str[2]);
+    shell_print(sh, "format:    %s", atomic_get(&app_cfg.binary) ? "binary" : "text");
     
     return 0;
 }
 
-// Function to scan I2C bus
-void scan_i2c_bus(void)
+// aht10 period [<ms>]
+int cmd_period(const struct shell *sh, size_t argc, char **argv)
+{
+    char *end;
+    long value;
+    
+    if (argc < 2) {
+        shell_print(sh, "%d ms", (int)atomic_get(&app_cfg.period_ms));
+        return 0;
+    }
+    
+    value = strtol(argv[1], &end, 10);
+    if (*end != '\0' || value < PERIOD_MIN_MS || value > PERIOD_MAX_MS) {
+        shell_error(sh, "period must be %d..%d ms", PERIOD_MIN_MS, PERIOD_MAX_MS);
+        return -EINVAL;
+    }
+    
+    return shell_param_set(sh, "period", value);
+}
+
+// aht10 thresh [<temp_low|temp_high|humidity> <value>]
+int cmd_thresh(const struct shell *sh, size_t argc, char **argv)
+{
+    char str[FIXEDPOINT_CENTI_STR_LEN];
+    int32_t value;
+    
+    if (argc < 2) {
+        return cmd_show(sh, argc, argv);
+    }
+    
+    if (argc != 3 || (strcmp(argv[1], "temp_low") != 0 && strcmp(argv[1], "temp_high") != 0 &&
+                      strcmp(argv[1], "humidity") != 0)) {
+        shell_error(sh, "usage: aht10 thresh <temp_low|temp_high|humidity> <value>");
+        return -EINVAL;
+    }
+    
+    if (fixedpoint_str_to_centi(argv[2], &value) != 0) {
+        shell_error(sh, "bad value: %s", argv[2]);
+        return -EINVAL;
+    }
+    
+    // The temperature LED needs a band between the two thresholds
+    if (strcmp(argv[1], "temp_low") == 0 && value >= atomic_get(&app_cfg.temp_high)) {
+        fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_high), str);
+        shell_error(sh, "temp_low must be below temp_high (%s C)", str);
+        return -EINVAL;
+    }
+    if (strcmp(argv[1], "temp_high") == 0 && value <= atomic_get(&app_cfg.temp_low)) {
+        fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_low), str);
+        shell_error(sh, "temp_high must be above temp_low (%s C)", str);
+        return -EINVAL;
+    }
+    
+    return shell_param_set(sh, argv[1], value);
+}
+
+// aht10 format [text|binary]
+int cmd_format(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc < 2) {
+        shell_print(sh, "%s", atomic_get(&app_cfg.binary) ? "binary" : "text");
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "text") == 0) {
+        return shell_param_set(sh, "format", 0);
+    }
+    if (strcmp(argv[1], "binary") == 0) {
+        return shell_param_set(sh, "format", 1);
+    }
+    
+    shell_error(sh, "format is text or binary");
+    return -EINVAL;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_aht10,
+    SHELL_CMD(show, NULL, "Show the current configuration", cmd_show),
+    SHELL_CMD_ARG(period, NULL, "Sampling period: period [<ms>]", cmd_period, 1, 1),
+    SHELL_CMD_ARG(thresh, NULL,
+                  "LED thresholds: thresh [<temp_low|temp_high|humidity> <value>]",
+                  cmd_thresh, 1, 2),
+    SHELL_CMD_ARG(format, NULL, "Data output format: format [text|binary]", cmd_format, 1, 1),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(aht10, &sub_aht10, "AHT10 monitor configuration", NULL);
+#endif
+
+K_THREAD_DEFINE(acq_thread, ACQ_STACK_SIZE, acq_thread_entry, NULL, NULL, NULL,
+                CONFIG_APP_ACQ_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
+#ifdef CONFIG_APP_SAMPLE_LOG
+// One step above the other observers: a record is in flash before the UART
+// observer reports on the log
+K_THREAD_DEFINE(store_thread, OBSERVER_STACK_SIZE, observer_thread_entry, &store_obs, NULL,
+                NULL, CONFIG_APP_OUTPUT_THREAD_PRIORITY - 1, 0, SYS_FOREVER_MS);
+#endif
+K_THREAD_DEFINE(led_thread, OBSERVER_STACK_SIZE, observer_thread_entry, &led_obs, NULL, NULL,
+                CONFIG_APP_OUTPUT_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
+K_THREAD_DEFINE(console_thread, OBSERVER_STACK_SIZE, observer_thread_entry, &console_obs, NULL,
+                NULL, CONFIG_APP_OUTPUT_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
+K_THREAD_DEFINE(uart_thread, UART_STACK_SIZE, uart_thread_entry, NULL, NULL, NULL,
+                CONFIG_APP_OUTPUT_THREAD_PRIORITY, 0, SYS_FOREVER_MS);
+
+// Function to load the parameters saved from the shell
+void load_settings(void)
 {
-    uint8_t dummy_data = 0;
+#ifdef CONFIG_SETTINGS
     int ret;
-    int devices_found = 0;
     
-    printk("Starting I2C bus scan...\n");
-    printk("Scanning addresses 0x08 to 0x77\n");
-    printk("     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n");
+    // Values saved from the shell override the build-time defaults
+    ret = settings_subsys_init();
+    if (ret == 0) {
+        ret = settings_load_subtree("app");
+    }
+    if (ret != 0) {
+        printk("WARNING: Failed to load settings (error: %d), using defaults\n", ret);
+    }
+#endif
+}
+
+// Function to print the thresholds and output settings in effect
+void print_startup(void)
+{
+    char thresh_str[3][FIXEDPOINT_CENTI_STR_LEN];
     
-    for (int addr = 0; addr < 128; addr++) {
-        // Print address row header
-        if (addr % 16 == 0) {
-            printk("%02x: ", addr);
-        }
-        
-        // Skip reserved addresses
-        if (addr < 0x08 || addr > 0x77) {
-            printk("   ");
-        } else {
-            // Try to communicate with device at this address
-            ret = i2c_write(i2c_dev, &dummy_data, 0, addr);
-            
-            if (ret == 0) {
-                // Device found
-                printk("%02x ", addr);
-                devices_found++;
-            } else {
-                // No device at this address  
-                printk("-- ");
-            }
-        }
-        
-        // Print newline at end of row
-        if ((addr + 1) % 16 == 0) {
-            printk("\n");
-        }
-        
-        // Small delay between scans
-        k_msleep(1);
+    printk("Starting temperature and humidity readings...\n");
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_low), thresh_str[0]);
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.temp_high), thresh_str[1]);
+    fixedpoint_centi_to_str(atomic_get(&app_cfg.humidity_high), thresh_str[2]);
+    printk("Thresholds: Low Temp: %s°C, High Temp: %s°C, High Humidity: %s%%\n",
+           thresh_str[0], thresh_str[1], thresh_str[2]);
+    printk("Sample period: %d ms, output: %s\n", (int)atomic_get(&app_cfg.period_ms),
+           atomic_get(&app_cfg.binary) ? "binary" : "text");
+    printk("============================================\n\n");
+}
+
+#ifdef CONFIG_APP_SAMPLE_LOG
+// Function to mount the flash log and start taking drain requests
+int start_sample_log(void)
+{
+    int ret;
+    
+    // Samples are kept in flash until the host sends 'D' to collect them
+    ret = sample_log_init();
+    if (ret != 0) {
+        printk("ERROR: Failed to mount the sample log (error: %d)\n", ret);
+        return ret;
     }
+    serial_tx_set_rx_callback(uart_rx_handler, NULL);
+    atomic_set(&log_ready, 1);
+    printk("Sample log ready (boot %u), send 'D' to drain\n", sample_log_boot_count());
     
-    printk("\nScan complete. Found %d device(s).\n\n", devices_found);
+    return 0;
+}
+#endif
+
+// Function to finish booting once the first sample is in (boot work queue)
+void boot_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+    
+    printk("First sample: %u us after boot (sensor %s)\n", first_sample_us,
+           aht10_reset_skipped(aht10_dev) ? "already calibrated" : "reset");
+    
+#ifdef CONFIG_APP_FAST_BOOT
+    // Sampling started with the build-time defaults
+    int32_t period_ms = atomic_get(&app_cfg.period_ms);
+    
+    load_settings();
+    if (atomic_get(&app_cfg.period_ms) != period_ms) {
+        sample_clock_set_period(&acq_clock, atomic_get(&app_cfg.period_ms));
+    }
+    
+    // Bus work waits for the reading in progress, if any, and holds off
+    // the next one (counted with the acquisition thread's own gets and
+    // puts in low-power mode)
+    k_mutex_lock(&bus_lock, K_FOREVER);
+#ifdef CONFIG_APP_LOW_POWER
+    power_get(&i2c_power);
+#endif
+#ifdef CONFIG_I2C_SPEED
+    negotiate_bus_speed();
+#endif
+    scan_i2c_bus();
+#ifdef CONFIG_APP_LOW_POWER
+    power_put(&i2c_power);
+#endif
+    k_mutex_unlock(&bus_lock);
+    
+#ifdef CONFIG_APP_SAMPLE_LOG
+    // Readings so far are still in the ring if the store observer starts
+    // within CONFIG_APP_SAMPLE_QUEUE_SIZE samples
+    if (start_sample_log() == 0) {
+        k_thread_start(store_thread);
+    }
+#endif
+    
+    print_startup();
+    
+#ifndef CONFIG_APP_LOW_POWER
+    test_leds();
+#endif
+#endif
 }
 
 int main(void)
 {
-    float temperature, humidity;
     int ret;
     
     printk("STM32F411CEU6 BlackPill AHT10 with LED Control & UART Output\n");
     printk("============================================================\n");
     
+    // Fast boot samples with the build-time defaults until the boot work
+    // has loaded the saved ones
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT)) {
+        load_settings();
+    }
+    
     // Get I2C device
-    i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c1));
+    i2c_dev = DEVICE_DT_GET(DT_BUS(AHT10_NODE));
     if (!device_is_ready(i2c_dev)) {
         printk("ERROR: I2C device not ready\n");
         return -1;
@@ -304,12 +1839,17 @@ int main(void)
     printk("I2C device ready\n");
     
     // Get UART device
-    uart_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
-    if (!device_is_ready(uart_dev)) {
+    uart_dev = DEVICE_DT_GET(TELEMETRY_UART_NODE);
+    ret = serial_tx_init(uart_dev);
+    if (ret != 0) {
         printk("ERROR: UART device not ready\n");
         return -1;
     }
     printk("UART device ready\n");
+    if (IS_ENABLED(CONFIG_APP_OUTPUT_BINARY) && !OUTPUT_BINARY_ALLOWED) {
+        printk("WARNING: %s is also the console, sending text instead of binary\n",
+               uart_dev->name);
+    }
     
     // Initialize LEDs
     ret = init_leds();
@@ -318,69 +1858,103 @@ int main(void)
         return -1;
     }
     
-    // Test LEDs briefly
-    printk("Testing LEDs...\n");
-    gpio_pin_set_dt(&red_led, 1);
-    k_msleep(500);
-    gpio_pin_set_dt(&red_led, 0);
-    gpio_pin_set_dt(&green_led, 1);
-    k_msleep(500);
-    gpio_pin_set_dt(&green_led, 0);
-    gpio_pin_set_dt(&blue_led, 1);
-    k_msleep(500);
-    gpio_pin_set_dt(&blue_led, 0);
-    printk("LED test complete\n");
-    
-    // Scan I2C bus first to verify AHT10 is detected
-    scan_i2c_bus();
+    // Fast boot leaves the LED test, bus scan, bus speed negotiation and
+    // flash log until after the first sample. The LED test is skipped in
+    // low-power mode.
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT)) {
+        if (!IS_ENABLED(CONFIG_APP_LOW_POWER)) {
+            test_leds();
+        }
+        
+        // Scan I2C bus first to verify AHT10 is detected
+        scan_i2c_bus();
+    }
     
-    // Initialize AHT10 sensor
-    ret = aht10_init();
-    if (ret != 0) {
+    // The driver resets and calibrates the sensor at boot (unless it
+    // already is, with fast boot)
+    if (!device_is_ready(aht10_dev)) {
         printk("ERROR: Failed to initialize AHT10 sensor\n");
         return -1;
     }
+    printk("AHT10 sensor ready\n");
+    
+#ifdef CONFIG_I2C_SPEED
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT)) {
+        negotiate_bus_speed();
+    }
+#endif
     
     // Send startup message via UART
-    char startup_msg[] = "AHT10 Temperature & Humidity Monitor Started\r\n";
-    for (int i = 0; i < strlen(startup_msg); i++) {
-        uart_poll_out(uart_dev, startup_msg[i]);
+    send_uart_message("AHT10 Temperature & Humidity Monitor Started\r\n");
+    
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT)) {
+        print_startup();
     }
     
-    printk("Starting temperature and humidity readings...\n");
-    printk("Thresholds: Low Temp: %.1f°C, High Temp: %.1f°C, High Humidity: %.1f%%\n",
-           TEMP_LOW_THRESHOLD, TEMP_HIGH_THRESHOLD, HUMIDITY_HIGH_THRESHOLD);
-    printk("============================================\n\n");
+    // The rest stays ahead of the first sample either way: none of it
+    // touches the bus or flash, and the threads use all of it from their
+    // first iteration
+#ifdef CONFIG_DEADBAND_REPORT
+    // Only send readings that moved, plus a heartbeat now and then
+    deadband_init(&report_gate, CONFIG_DEADBAND_TEMP_CENTI, CONFIG_DEADBAND_HUMIDITY_CENTI,
+                  CONFIG_DEADBAND_HEARTBEAT_SEC * MSEC_PER_SEC);
+#endif
     
-    while (1) {
-        // Read temperature and humidity
-        ret = aht10_read_data(&temperature, &humidity);
-        
-        if (ret == 0) {
-            // Display on console
-            printk("Temperature: %.2f°C\n", temperature);
-            printk("Humidity: %.2f%%\n", humidity);
-            
-            // Control LEDs based on readings
-            control_leds(temperature, humidity);
-            
-            // Send data via UART
-            send_uart_data(temperature, humidity);
-            
-            printk("------------------------\n");
-        } else {
-            printk("ERROR: Failed to read AHT10 data (error: %d)\n", ret);
-            
-            // Send error via UART
-            char error_msg[] = "ERROR: Sensor read failed\r\n";
-            for (int i = 0; i < strlen(error_msg); i++) {
-                uart_poll_out(uart_dev, error_msg[i]);
-            }
-        }
-        
-        // Wait 2 seconds before next reading
-        k_sleep(K_SECONDS(2));
+#ifdef CONFIG_APP_SAMPLE_LOG
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT) && start_sample_log() != 0) {
+        return -1;
+    }
+#endif
+    
+#ifdef CONFIG_APP_LOW_POWER
+    // From here on the bus and the UART sleep unless they are in use
+    printk("Low-power mode: output every %d samples\n", CONFIG_APP_OUTPUT_BATCH);
+    power_init(&i2c_power, i2c_dev);
+    if (TELEMETRY_UART_IS_CONSOLE) {
+        printk("%s: console UART, stays on\n", uart_dev->name);
+    } else {
+        power_init(&uart_power, uart_dev);
+    }
+#endif
+    
+#ifdef CONFIG_APP_BENCHMARK
+    struct serial_tx_stats tx_stats;
+    
+    serial_tx_get_stats(&tx_stats);
+    bench_bytes_start = tx_stats.bytes_sent + serial_tx_pending();
+    bench_ready_us = bench_uptime_us();
+#endif
+    
+#ifdef CONFIG_APP_WATCHDOG
+    // A hung acquisition loop resets the system; the hardware watchdog,
+    // where there is one, catches the task watchdog itself
+    ret = task_wdt_init(DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0)));
+    acq_wdt_channel = (ret == 0) ?
+        task_wdt_add(CONFIG_APP_WATCHDOG_TIMEOUT_MS, NULL, NULL) : ret;
+    if (acq_wdt_channel < 0) {
+        printk("ERROR: Failed to set up the watchdog (error: %d)\n", acq_wdt_channel);
+        return -1;
+    }
+    printk("Watchdog: %d ms\n", CONFIG_APP_WATCHDOG_TIMEOUT_MS);
+#endif
+    
+    k_work_queue_start(&boot_workq, boot_work_stack, K_THREAD_STACK_SIZEOF(boot_work_stack),
+                       CONFIG_APP_OUTPUT_THREAD_PRIORITY + 1, NULL);
+    
+    // First tick right away, then every period on a fixed grid
+    sample_clock_start(&acq_clock, atomic_get(&app_cfg.period_ms));
+    
+    // Hand over to the acquisition thread and the observers (with fast
+    // boot, the store observer starts once the log is mounted)
+#ifdef CONFIG_APP_SAMPLE_LOG
+    if (!IS_ENABLED(CONFIG_APP_FAST_BOOT)) {
+        k_thread_start(store_thread);
     }
+#endif
+    k_thread_start(led_thread);
+    k_thread_start(console_thread);
+    k_thread_start(uart_thread);
+    k_thread_start(acq_thread);
     
     return 0;
 }
\ No newline at end of file
@@ -5,56 +5,157 @@
 #include <zephyr/drivers/uart.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/logging/log.h>
+#include <app/lib/i2c_scan.h>
+#include <app/lib/bench.h>
+#include <app/drivers/sensor/aht10_emul.h>
 
 LOG_MODULE_REGISTER(i2c_scanner, LOG_LEVEL_INF);
 
+// Bus to scan (falls back to I2C1)
+#if DT_HAS_CHOSEN(app_scan_bus)
+#define SCAN_BUS_NODE DT_CHOSEN(app_scan_bus)
+#else
+#define SCAN_BUS_NODE DT_NODELABEL(i2c1)
+#endif
+
 // I2C device pointer
 static const struct device *i2c_dev;
 
+// Function to scan I2C bus
 void scan_i2c_bus(void)
 {
-    uint8_t dummy_data = 0;
-    int ret;
-    int devices_found = 0;
+    struct i2c_scan_result result;
     
     printk("Starting I2C bus scan...\n");
     printk("Scanning addresses 0x08 to 0x77\n");
-    printk("     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n");
     
-    for (int addr = 0; addr < 128; addr++) {
-        // Print address row header
-        if (addr % 16 == 0) {
-            printk("%02x: ", addr);
-        }
+    // Back-to-back zero-length probes into a bitmap; the table is printed
+    // once at the end so console output doesn't slow the scan down
+    if (i2c_scan_bus(i2c_dev, &result) != 0) {
+        printk("ERROR: I2C bus scan failed\n");
+        return;
+    }
+    
+    i2c_scan_print(&result);
+}
+
+#ifdef CONFIG_APP_SCAN_BENCHMARK
+// Function to time full scans at each bus speed the controller accepts
+void benchmark_scan(void)
+{
+    static const uint32_t speeds[] = {
+        I2C_SPEED_STANDARD, I2C_SPEED_FAST, I2C_SPEED_FAST_PLUS,
+    };
+    struct i2c_scan_result result;
+    uint32_t saved_config;
+    char metric[32];
+    bool restore;
+    
+    restore = (i2c_get_config(i2c_dev, &saved_config) == 0);
+    
+    printk("Scan benchmark: %d rounds per speed\n", CONFIG_APP_SCAN_BENCHMARK_ROUNDS);
+    
+    for (size_t i = 0; i < ARRAY_SIZE(speeds); i++) {
+        uint32_t min_us = UINT32_MAX, max_us = 0;
+        uint64_t total_us = 0;
         
-        // Skip reserved addresses
-        if (addr < 0x08 || addr > 0x77) {
-            printk("   ");
-        } else {
-            // Try to communicate with device at this address
-            ret = i2c_write(i2c_dev, &dummy_data, 0, addr);
-            
-            if (ret == 0) {
-                // Device found
-                printk("%02x ", addr);
-                devices_found++;
-            } else {
-                // No device at this address
-                printk("-- ");
-            }
+        if (i2c_configure(i2c_dev, I2C_SPEED_SET(speeds[i]) | I2C_MODE_CONTROLLER) != 0) {
+            printk("  speed %u: not supported by controller\n", speeds[i]);
+            continue;
         }
         
-        // Print newline at end of row
-        if ((addr + 1) % 16 == 0) {
-            printk("\n");
+        for (int round = 0; round < CONFIG_APP_SCAN_BENCHMARK_ROUNDS; round++) {
+            i2c_scan_bus(i2c_dev, &result);
+            min_us = MIN(min_us, result.duration_us);
+            max_us = MAX(max_us, result.duration_us);
+            total_us += result.duration_us;
         }
         
-        // Small delay between scans
-        k_msleep(1);
+        printk("  %7u Hz: min %u us, avg %u us, max %u us (%u device(s))\n",
+               result.bitrate, min_us,
+               (uint32_t)(total_us / CONFIG_APP_SCAN_BENCHMARK_ROUNDS), max_us,
+               result.count);
+        
+        // Same figures for twister to record
+        snprintk(metric, sizeof(metric), "scan.%uhz.min_us", result.bitrate);
+        bench_report(metric, min_us);
+        snprintk(metric, sizeof(metric), "scan.%uhz.avg_us", result.bitrate);
+        bench_report(metric, total_us / CONFIG_APP_SCAN_BENCHMARK_ROUNDS);
+        snprintk(metric, sizeof(metric), "scan.%uhz.max_us", result.bitrate);
+        bench_report(metric, max_us);
+    }
+    
+    if (restore) {
+        i2c_configure(i2c_dev, saved_config);
     }
     
-    printk("\nScan complete. Found %d device(s).\n\n", devices_found);
+    printk("Scan benchmark complete\n\n");
 }
+#endif
+
+#ifdef CONFIG_APP_SCAN_MONITOR
+// Function to report a hot-plug change
+void report_change(uint8_t addr, bool present, void *user_data)
+{
+    ARG_UNUSED(user_data);
+    
+    printk("Device %s at 0x%02x\n", present ? "appeared" : "disappeared", addr);
+}
+
+#ifdef CONFIG_APP_SCAN_MONITOR_EMUL_HOTPLUG
+// Emulated sensors that come and go, and the cycle they do it in
+#define HOTPLUG_ARRIVING_NODE DT_NODELABEL(aht10_39)
+#define HOTPLUG_LEAVING_NODE  DT_NODELABEL(aht10_38)
+#define HOTPLUG_CYCLE         3
+
+// Function to plug and unplug emulated sensors, called once per cycle
+void simulate_hotplug(void)
+{
+    static int cycle;
+    const struct emul *arriving = EMUL_DT_GET(HOTPLUG_ARRIVING_NODE);
+    const struct emul *leaving = EMUL_DT_GET(HOTPLUG_LEAVING_NODE);
+    
+    if (cycle == 0) {
+        aht10_emul_set_present(arriving, false);
+    } else if (cycle == HOTPLUG_CYCLE) {
+        aht10_emul_set_present(arriving, true);
+        aht10_emul_set_present(leaving, false);
+    }
+    cycle++;
+}
+#endif
+
+// Function to watch the bus for devices coming and going
+void monitor_i2c_bus(void)
+{
+    static struct i2c_scan_monitor monitor;
+    
+#ifdef CONFIG_APP_SCAN_MONITOR_EMUL_HOTPLUG
+    simulate_hotplug();
+#endif
+    
+    // One full scan to learn what's there
+    printk("Starting I2C bus scan...\n");
+    printk("Scanning addresses 0x08 to 0x77\n");
+    if (i2c_scan_monitor_init(&monitor, i2c_dev, CONFIG_APP_SCAN_MONITOR_SLICE) != 0) {
+        printk("ERROR: I2C bus scan failed\n");
+        return;
+    }
+    i2c_scan_print(&monitor.known);
+    
+    printk("Monitoring for changes every %d ms (%d empty addresses per cycle)...\n",
+           CONFIG_APP_SCAN_MONITOR_PERIOD_MS, CONFIG_APP_SCAN_MONITOR_SLICE);
+    
+    // From here on only changes are printed
+    while (1) {
+        k_sleep(K_MSEC(CONFIG_APP_SCAN_MONITOR_PERIOD_MS));
+#ifdef CONFIG_APP_SCAN_MONITOR_EMUL_HOTPLUG
+        simulate_hotplug();
+#endif
+        i2c_scan_monitor_poll(&monitor, report_change, NULL);
+    }
+}
+#endif
 
 int main(void)
 {
@@ -62,7 +163,7 @@ int main(void)
     printk("===================================\n");
     
     // Get I2C device
-    i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c1));
+    i2c_dev = DEVICE_DT_GET(SCAN_BUS_NODE);
     if (!device_is_ready(i2c_dev)) {
         printk("ERROR: I2C device not ready\n");
         return -1;
@@ -70,6 +171,14 @@ int main(void)
     
     printk("I2C device ready\n");
     
+#ifdef CONFIG_APP_SCAN_BENCHMARK
+    benchmark_scan();
+#endif
+    
+#ifdef CONFIG_APP_SCAN_MONITOR
+    monitor_i2c_bus();
+#endif
+    
     while (1) {
         scan_i2c_bus();
         